@@ -10,6 +10,7 @@
 #define M_BASE_SDL2_VBASEI_HH
 
 #include <memory>
+#include <vector>
 
 #include "base/sdl2.hh"
 #include "base/sdl2/hbasei.hh"
@@ -18,6 +19,11 @@
 #include "sbuf.hh"
 #include "vbase.hh"
 
+// SDL_RenderGeometry is only available since SDL 2.0.18
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+#define VBACKEND_SDL2_GEOMETRY 1
+#endif
+
 namespace hiemalia {
 class VideoModuleSDL2 : public VideoModule {
   public:
@@ -51,6 +57,18 @@ class VideoModuleSDL2 : public VideoModule {
     SDL_Rect square_;
     SDL_Rect rect_;
     std::vector<SDL_Point> points_;
+
+    void drawLines(const SplinterBuffer& buffer);
+#ifdef VBACKEND_SDL2_GEOMETRY
+    // all segments between two clip rect changes go out in one call
+    void drawGeometry(const SplinterBuffer& buffer);
+    void addSegment(int x0, int y0, int x1, int y1, const SDL_Color& color,
+                    bool last);
+    bool flushGeometry();
+    bool geometry_{true};
+    std::vector<SDL_Vertex> vertices_;
+    std::vector<int> indices_;
+#endif
 };
 };  // namespace hiemalia
 
@@ -0,0 +1,77 @@
+/****************************************************************************/
+/*                                                                          */
+/*   HIEMALIA SOURCE CODE (C) 2021      SAMPO HIPPELAINEN (HISAHI).         */
+/*   SEE THE LICENSE FILE IN THE SOURCE ROOT DIRECTORY FOR LICENSE INFO.    */
+/*                                                                          */
+/****************************************************************************/
+// base/soft/vbasei.hh: header file for software video module implementation
+
+#ifndef M_BASE_SOFT_VBASEI_HH
+#define M_BASE_SOFT_VBASEI_HH
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "defs.hh"
+#include "inherit.hh"
+#include "sbuf.hh"
+#include "vbase.hh"
+
+namespace hiemalia {
+// rasterizes splinters into an in-memory RGBA framebuffer with additive
+// blending (same as SDL_BLENDMODE_ADD). nothing is ever shown on screen
+class VideoModuleSoft : public VideoModule {
+  public:
+    std::string name() const noexcept { return name_; }
+
+    bool canSetFullscreen();
+
+    void frame();
+    void blank();
+    void draw(const SplinterBuffer& buffer);
+    void blit();
+    void sync();
+    bool isFullScreen();
+    void setFullScreen(bool flag);
+    bool dumpFrame(const std::string& filename) override;
+
+    inline int width() const noexcept { return width_; }
+    inline int height() const noexcept { return height_; }
+    // R, G, B, A bytes per pixel, rows top to bottom
+    inline const std::vector<uint8_t>& pixels() const noexcept {
+        return pixels_;
+    }
+
+    explicit VideoModuleSoft(const std::shared_ptr<HostModule>& host,
+                             int width = defaultSize, int height = defaultSize);
+    DELETE_COPY(VideoModuleSoft);
+    DEFAULT_MOVE(VideoModuleSoft);
+    ~VideoModuleSoft() noexcept {}
+
+  private:
+    struct ClipRect {
+        int x0, y0, x1, y1;  // inclusive
+    };
+
+    static inline const std::string name_ = "VideoModuleSoft";
+    static constexpr int defaultSize = 512;
+    static constexpr int chunkSize = 256;
+    int width_;
+    int height_;
+    coord_t cx_, cy_, scale_;
+    ClipRect square_;
+    ClipRect clip_;
+    std::shared_ptr<HostModule> host_;
+    std::vector<uint8_t> pixels_;
+    std::vector<int32_t> chunkX_;
+    std::vector<int32_t> chunkY_;
+
+    void drawLine(int x0, int y0, int x1, int y1, const Color& c, bool last);
+    bool writePPM(const std::string& filename) const;
+    bool writePNG(const std::string& filename) const;
+};
+};  // namespace hiemalia
+
+#endif  // M_BASE_SOFT_VBASEI_HH
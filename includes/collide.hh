@@ -10,6 +10,8 @@
 #define M_COLLIDE_HH
 
 #include <algorithm>
+#include <memory>
+#include <vector>
 
 #include "defs.hh"
 #include "model.hh"
@@ -55,18 +57,82 @@ struct CollisionShape {
     CollisionShape(CollisionShapeType type, const Point3D& p, coord_t r2)
         : type(type), p(p), r(r2) {}
 };
+struct CollisionSphere {
+    Point3D center;
+    coord_t radius;
+};
+struct CollisionLine {
+    Point3D p1;
+    Point3D p2;
+};
+struct CollisionCuboid {
+    Point3D c1;
+    Point3D c2;
+};
+struct CollisionTri {
+    Point3D t1;
+    Point3D t2;
+    Point3D t3;
+};
 struct ModelCollision {
     std::vector<CollisionShape> shapes;
+    // the shapes again, grouped by type so that the queries can run one loop
+    // per type instead of switching on every shape
+    std::vector<Point3D> points;
+    std::vector<CollisionLine> lines;
+    std::vector<CollisionCuboid> cuboids;
+    std::vector<CollisionSphere> spheres;
+    std::vector<CollisionTri> tris;
+    // contain every shape; queries that miss them skip all of the shapes
+    Point3D boxMin{0, 0, 0};
+    Point3D boxMax{0, 0, 0};
+    CollisionSphere bounds{Point3D(0, 0, 0), -1};
+
     inline ModelCollision() : shapes() {}
-    inline ModelCollision(int size) : shapes(size, CollisionShape::blank()) {}
+    inline ModelCollision(int size) : shapes(size, CollisionShape::blank()) {
+        update();
+    }
     inline ModelCollision(std::vector<CollisionShape>&& movevec)
-        : shapes(std::move(movevec)) {}
+        : shapes(std::move(movevec)) {
+        update();
+    }
+    // fills in the groups and bounds from shapes
+    void update();
 };
 struct ModelCollisionRadius {
     coord_t hitRadius;
     std::vector<CollisionShape> shapes;
 };
 
+// the shape moved into world space by a model matrix
+CollisionShape transformShape(const CollisionShape& shape,
+                              const Matrix3DAffine& mat);
+
+// the shapes of a ModelCollision in world space, with the groups and bounds
+// updated. they are only transformed again once the matrix or the
+// ModelCollision is different; shapes changed in place need invalidate.
+// the storage is handed on to the next cache when one is destroyed, so that
+// new objects do not allocate. like the object pools, only for one thread.
+// copies start out empty
+class WorldCollisionCache {
+  public:
+    WorldCollisionCache() noexcept {}
+    WorldCollisionCache(const WorldCollisionCache&) noexcept {}
+    inline WorldCollisionCache& operator=(const WorldCollisionCache&) noexcept {
+        invalidate();
+        return *this;
+    }
+    ~WorldCollisionCache();
+    const ModelCollision& get(const ModelCollision& mc,
+                              const Matrix3DAffine& mat);
+    inline void invalidate() noexcept { src_ = nullptr; }
+
+  private:
+    std::unique_ptr<ModelCollision> world_;
+    Matrix3DAffine mat_;
+    const ModelCollision* src_{nullptr};
+};
+
 bool collidesPointSphere(const Point3D& point, const Point3D& center,
                          coord_t radius);
 bool collidesLineSphere(const Point3D& line1, const Point3D& line2,
@@ -104,44 +170,78 @@ bool collidesTriTri(const Point3D& tri1_1, const Point3D& tri1_2,
                     const Point3D& tri1_3, const Point3D& tri2_1,
                     const Point3D& tri2_2, const Point3D& tri2_3);
 
-struct CollisionSphere {
-    Point3D center;
-    coord_t radius;
-};
-
 bool collidesLineShape(const Point3D& p1, const Point3D& p2,
-                       const CollisionShape& shape, const Matrix3D& mat);
+                       const CollisionShape& shape, const Matrix3DAffine& mat);
 bool collidesCuboidShape(const Point3D& c1, const Point3D& c2,
-                         const CollisionShape& shape, const Matrix3D& mat);
+                         const CollisionShape& shape,
+                         const Matrix3DAffine& mat);
 bool collidesSphereShape(const Point3D& c, coord_t r,
-                         const CollisionShape& shape, const Matrix3D& mat);
+                         const CollisionShape& shape,
+                         const Matrix3DAffine& mat);
 
 bool collidesLineModel(const Point3D& p1, const Point3D& p2,
-                       const ModelCollision& mc, const Matrix3D& mat);
+                       const ModelCollision& mc, const Matrix3DAffine& mat);
 bool collidesCuboidModel(const Point3D& c1, const Point3D& c2,
-                         const ModelCollision& mc, const Matrix3D& mat);
+                         const ModelCollision& mc, const Matrix3DAffine& mat);
 bool collidesSphereModel(const Point3D& c, coord_t r, const ModelCollision& mc,
-                         const Matrix3D& mat);
-bool collidesModelModel(const ModelCollision& mc1, const Matrix3D& mat1,
-                        const ModelCollision& mc2, const Matrix3D& mat2);
+                         const Matrix3DAffine& mat);
+bool collidesModelModel(const ModelCollision& mc1, const Matrix3DAffine& mat1,
+                        const ModelCollision& mc2, const Matrix3DAffine& mat2);
 
 bool collidesSweepSpherePoint(const Point3D& c1, const Point3D& c2, coord_t r,
                               const Point3D& p);
 bool collidesSweepSphereModel(const Point3D& c1, const Point3D& c2, coord_t r,
-                              const ModelCollision& mc, const Matrix3D& mat);
-
-Point3D collidesSweepSphereSphereWhere(const Point3D& line1,
-                                       const Point3D& line2, coord_t radius,
-                                       const Point3D& s_center,
-                                       coord_t s_radius);
-Point3D collidesSweepSphereCuboidWhere(const Point3D& line1,
-                                       const Point3D& line2, coord_t radius,
-                                       const Point3D& cuboid1,
-                                       const Point3D& cuboid2);
-Point3D collidesSweepSphereModelWhere(const Point3D& line1,
-                                      const Point3D& line2, coord_t radius,
-                                      const ModelCollision& mc,
-                                      const Matrix3D& mat);
+                              const ModelCollision& mc,
+                              const Matrix3DAffine& mat);
+
+// where a sphere of radius r moving from c1 to c2 first touches something
+struct SweepImpact {
+    bool hit{false};
+    // how far from c1 to c2 the sphere got, from 0 to 1
+    coord_t t{1};
+    // the center of the sphere at t
+    Point3D center{0, 0, 0};
+    // the point of the shape that the sphere touches
+    Point3D contact{0, 0, 0};
+    // the index of the shape in ModelCollision::shapes
+    size_t shape{0};
+};
+
+SweepImpact collidesSweepSphereSphereImpact(const Point3D& c1,
+                                            const Point3D& c2, coord_t r,
+                                            const Point3D& s_center,
+                                            coord_t s_radius);
+SweepImpact collidesSweepSphereCuboidImpact(const Point3D& c1,
+                                            const Point3D& c2, coord_t r,
+                                            const Point3D& cuboid1,
+                                            const Point3D& cuboid2);
+// the earliest impact with any of the shapes
+SweepImpact collidesSweepSphereModelImpact(const Point3D& c1,
+                                           const Point3D& c2, coord_t r,
+                                           const ModelCollision& mc,
+                                           const Matrix3DAffine& mat);
+// these take shapes that are already in world space (see WorldCollisionCache)
+bool collidesLineShape(const Point3D& p1, const Point3D& p2,
+                       const CollisionShape& shape);
+bool collidesCuboidShape(const Point3D& c1, const Point3D& c2,
+                         const CollisionShape& shape);
+bool collidesSphereShape(const Point3D& c, coord_t r,
+                         const CollisionShape& shape);
+bool collidesLineModel(const Point3D& p1, const Point3D& p2,
+                       const ModelCollision& mc);
+bool collidesCuboidModel(const Point3D& c1, const Point3D& c2,
+                         const ModelCollision& mc);
+bool collidesSphereModel(const Point3D& c, coord_t r, const ModelCollision& mc);
+bool collidesModelModel(const ModelCollision& mc1, const ModelCollision& mc2);
+bool collidesSweepSphereModel(const Point3D& c1, const Point3D& c2, coord_t r,
+                              const ModelCollision& mc);
+SweepImpact collidesSweepSphereShapeImpact(const Point3D& c1,
+                                           const Point3D& c2, coord_t r,
+                                           const CollisionShape& shape);
+SweepImpact collidesSweepSphereModelImpact(const Point3D& c1,
+                                           const Point3D& c2, coord_t r,
+                                           const ModelCollision& mc);
+
 Point3D collidesCuboidPointDirection(const Point3D& them, const Point3D& me,
                                      const Point3D& mySize);
 
@@ -20,8 +20,14 @@ namespace hiemalia {
 static inline const std::string gameVersion = "v0.9";
 static inline const std::string gameTitle = "Hiemalia " + gameVersion;
 
+// build with COORD_FLOAT=1 for single-precision coordinates
+#if COORD_FLOAT
+using coord_t = float;
+#define FMT_coord_t "%f"
+#else
 using coord_t = double;
 #define FMT_coord_t "%lf"
+#endif
 
 constexpr unsigned tickCount = 60;
 constexpr unsigned long long tickMicroseconds = 1000000ULL / tickCount;
@@ -0,0 +1,21 @@
+/****************************************************************************/
+/*                                                                          */
+/*   HIEMALIA SOURCE CODE (C) 2021      SAMPO HIPPELAINEN (HISAHI).         */
+/*   SEE THE LICENSE FILE IN THE SOURCE ROOT DIRECTORY FOR LICENSE INFO.    */
+/*                                                                          */
+/****************************************************************************/
+// game/bench.hh: header file for game logic benchmarks (game/bench.cc)
+
+#ifndef M_GAME_BENCH_HH
+#define M_GAME_BENCH_HH
+
+#include <ostream>
+#include <string>
+
+namespace hiemalia {
+// runs the benchmark with the given name (--bench) and prints the results.
+// returns false if there is no such benchmark. needs the game assets
+bool runBenchmark(const std::string& name, std::ostream& out);
+};  // namespace hiemalia
+
+#endif  // M_GAME_BENCH_HH
@@ -22,7 +22,9 @@ class Box : public GameObject {
     bool update(GameWorld& w, float delta);
 
   protected:
-    void absorbBullets(GameWorld& w, const BulletList& list);
+    // list is a BulletList or the BulletSystem
+    template <typename List>
+    void absorbBullets(GameWorld& w, List& list);
     void absorbEnemies(GameWorld& w, const EnemyList& list);
 };
 
@@ -34,7 +36,9 @@ class DestroyableBox : public Box, ObjectDamageable {
 
   private:
     bool alive_{true};
-    void absorbBullets(GameWorld& w, const BulletList& list);
+    // list is a BulletList or the BulletSystem
+    template <typename List>
+    void absorbBullets(GameWorld& w, List& list);
     void onDamage(GameWorld& w, float dmg, const Point3D& pointOfContact);
     void onDeath(GameWorld& w);
 };
@@ -9,6 +9,8 @@
 #ifndef M_GAME_BULLET_HH
 #define M_GAME_BULLET_HH
 
+#include <type_traits>
+
 #include "game/explode.hh"
 #include "game/object.hh"
 #include "game/stage.hh"
@@ -20,17 +22,30 @@ class BulletObject : public GameObject {
     BulletObject(const Point3D& pos);
     bool update(GameWorld& w, float delta);
     virtual bool doBulletTick(GameWorld& w, float delta) = 0;
+    // update with T's own doBulletTick
+    template <typename T>
+    inline bool updateAs(GameWorld& w, float delta) {
+        static_assert(std::is_same_v<decltype(&T::update),
+                                     decltype(&BulletObject::update)>,
+                      "bullets should override doBulletTick, not update");
+        return static_cast<T*>(this)->T::doBulletTick(w, delta) &&
+               afterTick(w, delta);
+    }
     virtual void impact(GameWorld& w, bool enemy) = 0;
     virtual bool firedByPlayer() const = 0;
     virtual void onMove(const Point3D& newPos);
     virtual float getDamage() const = 0;
     virtual bool hitsSweep(const GameObject& obj) const;
     virtual bool hitsInternal(const GameObject& obj) const;
+    inline const Model* instanceModel() const {
+        return hasModel() ? &model() : nullptr;
+    }
     Point3D lerp(coord_t p) const;
     void backtrackCuboid(const Point3D& c1, const Point3D& c2);
-    void backtrackSphere(const Point3D& p, coord_t r2);
-    void backtrackModel(const ModelCollision& mc, const Matrix3D mat);
-    void backtrackObject(const GameObject& o);
+    // where the last move of the bullet first touched obj
+    SweepImpact impactOn(const GameObject& obj) const;
+    // moves the bullet back to the impact; does nothing if there was none
+    void backtrack(const SweepImpact& impact);
     virtual ~BulletObject() {}
 
   protected:
@@ -40,6 +55,7 @@ class BulletObject : public GameObject {
   private:
     bool alive_{true};
     bool checkInBounds(GameWorld& w);
+    bool afterTick(GameWorld& w, float delta);
 };
 };  // namespace hiemalia
 
@@ -0,0 +1,151 @@
+/****************************************************************************/
+/*                                                                          */
+/*   HIEMALIA SOURCE CODE (C) 2021      SAMPO HIPPELAINEN (HISAHI).         */
+/*   SEE THE LICENSE FILE IN THE SOURCE ROOT DIRECTORY FOR LICENSE INFO.    */
+/*                                                                          */
+/****************************************************************************/
+// game/bullets.hh: header file for the enemy bullet system (game/bullets.cc)
+
+#ifndef M_GAME_BULLETS_HH
+#define M_GAME_BULLETS_HH
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "assets.hh"
+#include "defs.hh"
+#include "game/object.hh"
+#include "inherit.hh"
+#include "model.hh"
+#include "models.hh"
+
+namespace hiemalia {
+class GameWorld;
+class ObjectDrawer;
+class Renderer3D;
+class SplinterBuffer;
+
+// the arrays start with room for this many bullets. firing one more doubles
+// them, which moves every bullet, so a BulletRef must not be kept over a fire
+inline constexpr size_t bulletsCapacity = 512;
+
+// what a bullet does besides flying straight (see the kernels in
+// game/bullets.cc)
+enum class BulletKind : uint8_t {
+    Plain,
+    // turns towards the player while it is in front of them
+    Homing,
+    // jumps to target in x and y and takes newVel once it crosses target.z
+    Slide,
+    // becomes an obstacle once it reaches target.z
+    Blocker,
+};
+
+class BulletSystem;
+
+// one bullet of a BulletSystem, for the code written for the bullet lists
+// (such as the absorbBullets of the obstacles). operator-> returns the
+// reference itself, so that it can be used like the pointers in a list
+class BulletRef {
+  public:
+    const Point3D& pos;
+
+    inline BulletRef(BulletSystem& s, size_t i) noexcept;
+    inline const BulletRef* operator->() const noexcept { return this; }
+    inline coord_t sweepZMin() const noexcept;
+    inline coord_t sweepZMax() const noexcept;
+    bool hits(const GameObject& obj) const;
+    SweepImpact impactOn(const GameObject& obj) const;
+    void backtrack(const SweepImpact& impact) const;
+    void backtrackCuboid(const Point3D& c1, const Point3D& c2) const;
+    void impact(GameWorld& w, bool enemy) const;
+    inline float getDamage() const noexcept { return 1.0f; }
+
+  private:
+    BulletSystem& s_;
+    size_t i_;
+};
+
+// the simple enemy bullets. every property is kept in an array of its own
+// and update handles all bullets at once; the bullets that do more than fly
+// straight only add a small kernel for their kind
+class BulletSystem {
+  public:
+    BulletSystem();
+    DELETE_COPY(BulletSystem);
+    DEFAULT_MOVE(BulletSystem);
+
+    // target is only used by Slide and Blocker, newVel only by Slide
+    void fire(BulletKind kind, GameModel model, const Point3D& pos,
+              const Point3D& vel, coord_t scale = 1,
+              const Point3D& target = Point3D::origin,
+              const Point3D& newVel = Point3D::origin);
+    void clear();
+    void move(const Point3D& d);
+    // moves every bullet, hits the player with them and removes the ones
+    // that hit something or left the screen. the bullets keep their order
+    void update(GameWorld& w, float delta);
+    // only the bullets closer than lateZ
+    void render(SplinterBuffer& sbuf, Renderer3D& r3d, ObjectDrawer& drawer,
+                coord_t lateZ) const;
+
+    inline size_t size() const noexcept { return count_; }
+    inline BulletRef operator[](size_t i) noexcept {
+        return BulletRef(*this, i);
+    }
+
+  private:
+    enum Flags : uint8_t {
+        // cleared by an impact. the bullet still finishes its tick (and
+        // can even hit the player) before it is removed, like the objects
+        Alive = 1,
+        // a Slide bullet has crossed its target
+        Crossed = 2,
+        // removed at the start of the tick without an impact (a Blocker
+        // that was placed)
+        Gone = 4,
+    };
+
+    size_t count_{0};
+    std::vector<Point3D> pos_;
+    std::vector<Point3D> oldPos_;
+    std::vector<Point3D> vel_;
+    std::vector<Orient3D> rot_;
+    std::vector<Orient3D> rotvel_;
+    std::vector<coord_t> scale_;
+    std::vector<coord_t> radius_;
+    std::vector<GameModel> model_;
+    std::vector<BulletKind> kind_;
+    std::vector<uint8_t> flags_;
+    std::vector<Point3D> target_;
+    std::vector<Point3D> newVel_;
+    // where each bullet hit the player this tick, if it did
+    std::vector<SweepImpact> hit_;
+
+    void resize(size_t n);
+    void integrate(float delta);
+    void collidePlayer(GameWorld& w);
+    void resolve(GameWorld& w, float delta);
+    void explode(GameWorld& w, size_t i);
+    void steer(GameWorld& w, size_t i, float delta);
+    bool place(GameWorld& w, size_t i);
+    void slide(size_t i);
+
+    friend class BulletRef;
+};
+
+inline BulletRef::BulletRef(BulletSystem& s, size_t i) noexcept
+    : pos(s.pos_[i]), s_(s), i_(i) {}
+
+inline coord_t BulletRef::sweepZMin() const noexcept {
+    return std::min(s_.oldPos_[i_].z, s_.pos_[i_].z) - s_.radius_[i_];
+}
+
+inline coord_t BulletRef::sweepZMax() const noexcept {
+    return std::max(s_.oldPos_[i_].z, s_.pos_[i_].z) + s_.radius_[i_];
+}
+
+};  // namespace hiemalia
+
+#endif  // M_GAME_BULLETS_HH
@@ -43,6 +43,8 @@ class DemoFile {
 };
 
 std::shared_ptr<DemoFile> getNextDemo();
+// replaces the demo rotation with a single demo file
+void useOnlyDemo(const std::string& file);
 };  // namespace hiemalia
 
 #endif  // M_GAME_DEMO_HH
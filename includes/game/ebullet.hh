@@ -10,47 +10,32 @@
 #define M_GAME_EBULLET_HH
 
 #include "game/bullet.hh"
+#include "game/bullets.hh"
 #include "model.hh"
 
 namespace hiemalia {
-class EnemyBullet : public BulletObject {
-  public:
-    EnemyBullet(const Point3D& pos, const Point3D& v);
-    virtual bool doBulletTick(GameWorld& w, float delta);
-    void impact(GameWorld& w, bool enemy);
-    bool firedByPlayer() const;
-    float getDamage() const;
-    virtual ~EnemyBullet() {}
+// these bullets are not objects but live in the BulletSystem of the world.
+// GameWorld::fireEnemyBullet<T> calls T::fire
+struct EnemyBullet {
+    static void fire(BulletSystem& s, const Point3D& pos, const Point3D& v);
 };
 
-class EnemyBulletLaser : public EnemyBullet {
-  public:
-    EnemyBulletLaser(const Point3D& pos, const Point3D& v);
+struct EnemyBulletLaser {
+    static void fire(BulletSystem& s, const Point3D& pos, const Point3D& v);
 };
 
-class EnemyBulletHoming : public EnemyBullet {
-  public:
-    EnemyBulletHoming(const Point3D& pos, const Point3D& v);
-    bool doBulletTick(GameWorld& w, float delta);
+struct EnemyBulletHoming {
+    static void fire(BulletSystem& s, const Point3D& pos, const Point3D& v);
 };
 
-class EnemyBulletScalable : public EnemyBullet {
-  public:
-    EnemyBulletScalable(const Point3D& pos, const Point3D& v, coord_t scale,
-                        int palette = 0);
+struct EnemyBulletScalable {
+    static void fire(BulletSystem& s, const Point3D& pos, const Point3D& v,
+                     coord_t scale, int palette = 0);
 };
 
-class EnemyBulletSlideScalable : public EnemyBulletScalable {
-  public:
-    EnemyBulletSlideScalable(const Point3D& pos, const Point3D& v,
-                             const Point3D& dst, const Point3D& nv,
-                             coord_t scale);
-    bool doBulletTick(GameWorld& w, float delta);
-
-  private:
-    bool cross_{false};
-    Point3D target_;
-    Point3D newVel_;
+struct EnemyBulletSlideScalable {
+    static void fire(BulletSystem& s, const Point3D& pos, const Point3D& v,
+                     const Point3D& dst, const Point3D& nv, coord_t scale);
 };
 
 };  // namespace hiemalia
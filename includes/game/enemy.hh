@@ -9,6 +9,8 @@
 #ifndef M_GAME_ENEMY_HH
 #define M_GAME_ENEMY_HH
 
+#include <type_traits>
+
 #include "game/ebullet.hh"
 #include "game/explode.hh"
 #include "game/object.hh"
@@ -24,6 +26,16 @@ class EnemyObject : public GameObject, public ObjectDamageable {
     EnemyObject(const Point3D& pos, float health);
     bool update(GameWorld& w, float delta);
     virtual bool doEnemyTick(GameWorld& w, float delta) = 0;
+    // update with T's own doEnemyTick
+    template <typename T>
+    inline bool updateAs(GameWorld& w, float delta) {
+        static_assert(std::is_same_v<decltype(&T::update),
+                                     decltype(&EnemyObject::update)>,
+                      "enemies should override doEnemyTick, not update");
+        if (sponge_ > 0) return spongeTick(w, delta);
+        if (!alive_) return false;
+        return static_cast<T*>(this)->T::doEnemyTick(w, delta);
+    }
     inline virtual bool hitEnemy(GameWorld& w, float dmg,
                                  const Point3D& pointOfContact) {
         return true;
@@ -76,6 +88,7 @@ class EnemyObject : public GameObject, public ObjectDamageable {
     bool killedByPlayer_{false};
     bool canHitWalls_{false};
     float sponge_{0.0f};
+    bool spongeTick(GameWorld& w, float delta);
     void onDamage(GameWorld& w, float dmg, const Point3D& pointOfContact);
     void onDeath(GameWorld& w);
 };
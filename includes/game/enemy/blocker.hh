@@ -24,10 +24,8 @@ class EnemyBlocker : public EnemyObject {
     float fireTime_{0};
 };
 
-class EnemyBulletBlocker : public EnemyBullet {
-  public:
-    EnemyBulletBlocker(const Point3D& pos, const Point3D& v);
-    bool doBulletTick(GameWorld& w, float delta);
+struct EnemyBulletBlocker {
+    static void fire(BulletSystem& s, const Point3D& pos, const Point3D& v);
 };
 
 };  // namespace hiemalia
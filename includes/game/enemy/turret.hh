@@ -29,6 +29,7 @@ class EnemyTurret : public EnemyObject {
     LoadedGameModel baseModel_;
     std::vector<ExtraCollision> exCol_;
     Orient3D baseRot_;
+    ModelMatrixCache baseMatrix_;
     Orient3D targetRot_;
 };
 };  // namespace hiemalia
@@ -33,6 +33,7 @@ class EnemyWheeledTurret : public EnemyObject {
     LoadedGameModel baseModel_;
     std::vector<ExtraCollision> exCol_;
     Orient3D baseRot_;
+    ModelMatrixCache baseMatrix_;
     Orient3D targetRot_;
     coord_t targetYaw_;
 };
@@ -4,64 +4,109 @@
 /*   SEE THE LICENSE FILE IN THE SOURCE ROOT DIRECTORY FOR LICENSE INFO.    */
 /*                                                                          */
 /****************************************************************************/
-// game/explode.hh: header file for the explosion object
+// game/explode.hh: header file for explosions (the particle system)
 
 #ifndef M_GAME_EXPLODE_HH
 #define M_GAME_EXPLODE_HH
 
-#include "assets.hh"
-#include "controls.hh"
+#include <cstdint>
+#include <vector>
+
+#include "defs.hh"
 #include "game/object.hh"
-#include "lvector.hh"
+#include "inherit.hh"
 #include "model.hh"
+#include "rend3d.hh"
 
 namespace hiemalia {
+class Renderer3D;
+class SplinterBuffer;
+
 inline constexpr size_t maxShards = 200;
+// explosions that can be alive at once. if the pool is full, the explosion
+// that has faded the most is reused
+inline constexpr size_t explosionsMax = 32;
 
-/*struct ExplosionShard {
-    Point3D p0;
-    Point3D p1;
-    Point3D pos;
-    Orient3D rot;
-    Point3D dpos;
-    Orient3D drot;
-};*/
+// refers to one explosion in a ParticleSystem. stays invalid once the
+// explosion is over or its slot is reused
+struct ParticleHandle {
+    uint16_t index{0};
+    uint16_t generation{0};
+
+    inline explicit operator bool() const noexcept { return generation != 0; }
+};
 
-class Explosion : public GameObject {
+// every explosion gets a fixed slice of maxShards shards from pools that are
+// allocated once; no allocations happen per explosion
+class ParticleSystem {
   public:
-    Explosion(const Point3D& pos, const GameObject& o, coord_t xm, coord_t ym,
-              coord_t zm, float explspeed);
-    Explosion(const Point3D& pos, const GameObject& o, const Model& m,
-              coord_t xm, coord_t ym, coord_t zm, float explspeed);
-    bool update(GameWorld& w, float delta);
-    void render(SplinterBuffer& sbuf, Renderer3D& r3d);
-    void adjustSpeed(coord_t s);
-    void onMove(const Point3D& newPos);
+    ParticleSystem();
+    DELETE_COPY(ParticleSystem);
+    DEFAULT_MOVE(ParticleSystem);
+
+    // breaks the model of o into shards flying away from pos. xm, ym, zm
+    // give the direction the shards fly to (-1, 0 or 1 along each axis).
+    // detached explosions are not updated, moved or drawn by the methods
+    // that handle all explosions
+    ParticleHandle explode(const Point3D& pos, const GameObject& o, coord_t xm,
+                           coord_t ym, coord_t zm, float explspeed,
+                           bool detached = false);
+    // the same for the model m at rot and scale
+    ParticleHandle explode(const Point3D& pos, const Model& m,
+                           const Orient3D& rot, const Point3D& scale,
+                           coord_t xm, coord_t ym, coord_t zm, float explspeed,
+                           bool detached = false);
+    void adjustSpeed(ParticleHandle h, coord_t s);
+    bool alive(ParticleHandle h) const noexcept;
+    const Point3D& position(ParticleHandle h) const;
+    void free(ParticleHandle h);
+    void clear();
+
+    // returns false once the explosion is over (it is then freed)
+    bool update(ParticleHandle h, float delta);
+    void render(ParticleHandle h, SplinterBuffer& sbuf, Renderer3D& r3d);
+
+    // these only handle explosions that are not detached
+    void update(float delta);
+    void move(const Point3D& d);
+    // only explosions that started closer than lateZ
+    void render(SplinterBuffer& sbuf, Renderer3D& r3d, coord_t lateZ);
 
   private:
-    LimitedVector<Point3D, maxShards> shards_p0_;
-    LimitedVector<Point3D, maxShards> shards_p1_;
-    LimitedVector<Point3D, maxShards> shards_pos_;
-    LimitedVector<Point3D, maxShards> shards_dpos_;
-    LimitedVector<Orient3D, maxShards> shards_rot_;
-    LimitedVector<Orient3D, maxShards> shards_drot_;
+    struct Emitter {
+        Point3D pos{0, 0, 0};
+        Color color{255, 128, 0, 255};
+        size_t count{0};
+        float alpha{1};
+        float explspeed{1};
+        // the delta the turns in step_ were computed for
+        float stepDelta{0};
+        uint16_t generation{0};
+        bool detached{false};
+    };
 
-    Model tempModel_;
-    float alpha_{1};
-    float explspeed_{1};
-    inline bool collideLineInternal(const Point3D& p1,
-                                    const Point3D& p2) const {
-        return false;
-    }
-    inline bool collideCuboidInternal(const Point3D& c1,
-                                      const Point3D& c2) const {
-        return false;
-    }
-    inline bool collideSphereInternal(const Point3D& p, coord_t r2) const {
-        return false;
-    }
+    std::vector<Emitter> emitters_;
+    std::vector<uint16_t> free_;
+    std::vector<uint16_t> live_;
+    std::vector<Point3D> p0_;
+    std::vector<Point3D> p1_;
+    std::vector<Point3D> pos_;
+    std::vector<Point3D> dpos_;
+    std::vector<Quaternion> rot_;
+    // angular velocity around the x, y and z axes of the shard
+    std::vector<Point3D> spin_;
+    // the turn every update makes, which only changes with delta
+    std::vector<Quaternion> step_;
+    size_t shards_{0};
 
-    void cutShards(coord_t xm, coord_t ym, coord_t zm);
+    Emitter* get(ParticleHandle h);
+    const Emitter* get(ParticleHandle h) const;
+    uint16_t allocate();
+    void release(size_t liveIndex);
+    bool updateEmitter(size_t e, float delta);
+    void renderEmitter(size_t e, SplinterBuffer& sbuf, Renderer3D& r3d);
+    void cutShards(size_t e, const Quaternion& rot, coord_t xm, coord_t ym,
+                   coord_t zm);
 };
 };  // namespace hiemalia
 
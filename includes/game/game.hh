@@ -11,10 +11,12 @@
 
 #include <algorithm>
 #include <string>
+#include <vector>
 
 #include "defs.hh"
 #include "game/demo.hh"
 #include "game/gamemsg.hh"
+#include "game/sched.hh"
 #include "game/world.hh"
 #include "inherit.hh"
 #include "lmodule.hh"
@@ -99,24 +101,30 @@ class GameMain : public LogicModule,
     void doGameComplete();
     void doGameCompleteTick(GameState& state, float interval);
     void doExitGame();
+    void endDemo(GameState& state);
     void doGameOver();
-    void drawObject(GameState& state, float interval, const ObjectPtr& obj);
-    bool updateObject(GameState& state, float interval, const ObjectPtr& obj);
+    void drawBullets(GameState& state);
+    void processBullets(GameState& state, float interval);
+    ObjectDrawer drawer_;
 
     template <typename T>
     void drawObjects(GameState& state, float interval, ObjectListBase<T>& v) {
-        std::for_each(v.begin(), v.end(), [&](const ObjectPtr& obj) -> void {
-            drawObject(state, interval, obj);
-        });
+        for (const auto& obj : v)
+            if (obj->pos.z < objectLateZ) drawer_.draw(state.sbuf, r3d_, *obj);
+        drawer_.flush(state.sbuf, r3d_);
     }
     template <typename T>
     void processObjects(GameState& state, float interval,
                         ObjectListBase<T>& v) {
-        v.erase(std::remove_if(v.begin(), v.end(),
-                               [&](const ObjectPtr& obj) -> bool {
-                                   return !updateObject(state, interval, obj);
-                               }),
-                v.end());
+        // the previous list has moved since the sweeps were built
+        world_->invalidateSweeps();
+        ObjectPass pass{*world_, interval, state.sbuf, r3d_, drawer_,
+                        objectLateZ};
+        // objects spawned into v during the pass stay after the others
+        size_t n = v.size();
+        size_t kept = updateObjects(pass, v.data(), v.data() + n) - v.data();
+        v.erase(v.begin() + kept, v.begin() + n);
+        drawer_.flush(state.sbuf, r3d_);
     }
 };
 };  // namespace hiemalia
@@ -30,7 +30,9 @@ class MovingBox : public GameObject {
     coord_t x_;
     coord_t v_;
     void updateBox(GameWorld& w, float delta);
-    void absorbBullets(GameWorld& w, const BulletList& list);
+    // list is a BulletList or the BulletSystem
+    template <typename List>
+    void absorbBullets(GameWorld& w, List& list);
     void absorbEnemies(GameWorld& w, const EnemyList& list);
 };
 };  // namespace hiemalia
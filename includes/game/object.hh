@@ -27,6 +27,19 @@ struct ExtraCollision {
         const std::shared_ptr<const ModelCollision>& collision,
         const Point3D& pos, const Orient3D& rot, const Point3D& scale)
         : collision(collision), pos(pos), rot(rot), scale(scale) {}
+
+    // pos is relative to the position of the object, base
+    inline const Matrix3DAffine& getModelMatrix(const Point3D& base) const {
+        return matrix_.get(base + pos, rot, scale);
+    }
+    // collision in world space
+    inline const ModelCollision& worldCollision(const Point3D& base) const {
+        return world_.get(*collision, getModelMatrix(base));
+    }
+
+  private:
+    mutable ModelMatrixCache matrix_;
+    mutable WorldCollisionCache world_;
 };
 
 class GameObject {
@@ -38,6 +51,16 @@ class GameObject {
 
     virtual inline void onSpawn(GameWorld& w) {}
     bool tick(GameWorld& w, float delta);
+    // tick without the virtual calls; T must be the type the object was
+    // made as (see game/sched.hh)
+    template <typename T>
+    inline bool tickAs(GameWorld& w, float delta) {
+        oldPos_ = pos;
+        if (!static_cast<T*>(this)->template updateAs<T>(w, delta))
+            return false;
+        if (oldPos_ == pos) doMove(delta);
+        return true;
+    }
     virtual inline void onMove(const Point3D& newPos) {}
     virtual inline void instant(GameWorld& w) {}
     void setPosition(const Point3D& p);
@@ -45,14 +68,32 @@ class GameObject {
     void move(const Point3D& pos);
     void move(coord_t x, coord_t y, coord_t z);
     virtual void render(SplinterBuffer& sbuf, Renderer3D& r3d);
+    // objects whose render only draws this model (at pos, rot, scale) can
+    // return it here; they are then drawn together with the other instances
+    virtual inline const Model* instanceModel() const { return nullptr; }
     virtual bool hits(const GameObject& obj) const;
+    // whether the collision spheres overlap, which hits checks first
+    bool nearby(const GameObject& obj) const;
+    // the same for a sphere that is not an object
+    bool nearby(const Point3D& p, coord_t r) const;
+    // the z range of the collision sphere between the last and current
+    // positions. hits can only succeed if the ranges of both objects overlap
+    inline coord_t sweepZMin() const {
+        return std::min(oldPos_.z, pos.z) - collideRadius_;
+    }
+    inline coord_t sweepZMax() const {
+        return std::max(oldPos_.z, pos.z) + collideRadius_;
+    }
     bool isOffScreen() const;
     bool isOffScreen2() const;
     bool isInRegion(GameWorld& w, coord_t extentLeft, coord_t extentRight,
                     coord_t extentTop, coord_t extentBottom) const;
-    Matrix3D getObjectModelMatrix() const;
+    const Matrix3DAffine& getObjectModelMatrix() const;
     inline const Model& model() const { return *model_; }
     inline const ModelCollision& collision() const { return *collision_; }
+    // collision() in world space, transformed again only after the object
+    // has moved, turned or been scaled
+    const ModelCollision& worldCollision() const;
     inline bool hasModel() const noexcept { return model_ != nullptr; }
     inline bool hasCollision() const noexcept { return collision_ != nullptr; }
     virtual const std::vector<ExtraCollision>& exCollisions() const;
@@ -67,12 +108,20 @@ class GameObject {
     void setCollisionRadius(coord_t r);
 
     virtual inline bool update(GameWorld& w, float delta) { return false; }
+    // update as T's own. hidden by the classes whose update calls another
+    // virtual function
+    template <typename T>
+    inline bool updateAs(GameWorld& w, float delta) {
+        return static_cast<T*>(this)->T::update(w, delta);
+    }
     void setModel(std::shared_ptr<const Model>&& model);
     void setCollision(std::shared_ptr<const ModelCollision>&& collision);
     void setModel(const Model& model);
     void setCollision(const ModelCollision& collision);
     void noModel();
     void noCollision();
+    // must be called after the shapes of collision() are changed in place
+    void collisionChanged();
     void useGameModel(GameModel model, bool useCollision = true);
     void doMove(float delta);
     void doMove(float delta, const Point3D& v);
@@ -83,6 +132,8 @@ class GameObject {
 
   private:
     coord_t collideRadius_{0};
+    mutable ModelMatrixCache modelMatrix_;
+    mutable WorldCollisionCache worldCollision_;
     std::shared_ptr<const Model> modelHolder_;
     std::shared_ptr<const ModelCollision> collisionHolder_;
     const Model* model_{modelHolder_.get()};
@@ -114,6 +165,11 @@ bool collidesSphereObject(const Point3D& center, coord_t radius,
                           const GameObject& object);
 bool collidesSweepSphereObject(const Point3D& c1, const Point3D& c2, coord_t r,
                                const GameObject& object);
+// the earliest impact on the object or any of its extra collisions; shape
+// indexes into the ModelCollision that was hit
+SweepImpact collidesSweepSphereObjectImpact(const Point3D& c1,
+                                            const Point3D& c2, coord_t r,
+                                            const GameObject& object);
 bool collidesObjectObject(const GameObject& obj1, const GameObject& obj2);
 };  // namespace hiemalia
 
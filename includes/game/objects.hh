@@ -9,13 +9,12 @@
 #ifndef M_GAME_OBJECTS_HH
 #define M_GAME_OBJECTS_HH
 
-#include <memory>
-
 #include "game/object.hh"
+#include "game/pool.hh"
 
 namespace hiemalia {
-std::shared_ptr<GameObject> loadObjectSpawn(Point3D p, const std::string& name,
-                                            const std::string& prop);
+PoolPtr<GameObject> loadObjectSpawn(Point3D p, const std::string& name,
+                                    const std::string& prop);
 };  // namespace hiemalia
 
 #endif  // M_GAME_OBJECTS_HH
@@ -26,7 +26,9 @@ class Obstacle : public GameObject {
 
   protected:
     bool alive_{true};
-    void absorbBullets(GameWorld& w, const BulletList& list);
+    // list is a BulletList or the BulletSystem
+    template <typename List>
+    void absorbBullets(GameWorld& w, List& list);
     void absorbEnemies(GameWorld& w, const EnemyList& list);
 };
 
@@ -38,7 +40,9 @@ class DestroyableObstacle : public Obstacle, public ObjectDamageable {
     virtual ~DestroyableObstacle() {}
 
   private:
-    void absorbBullets(GameWorld& w, const BulletList& list);
+    // list is a BulletList or the BulletSystem
+    template <typename List>
+    void absorbBullets(GameWorld& w, List& list);
     void onDamage(GameWorld& w, float dmg, const Point3D& pointOfContact);
     void onDeath(GameWorld& w);
 };
@@ -24,12 +24,12 @@ class PlayerObject : public GameObject, public ObjectDamageable {
     void updateGameEnd(GameWorld& w, float delta);
     bool playerInControl() const;
     void render(SplinterBuffer& sbuf, Renderer3D& r3d);
-    void enemyContact();
-    void wallContact(coord_t x, coord_t y, coord_t z);
+    void enemyContact(GameWorld& w);
+    void wallContact(GameWorld& w, coord_t x, coord_t y, coord_t z);
 
   private:
     ControlState inputs_;
-    std::unique_ptr<Explosion> explodeObject_;
+    ParticleHandle explosion_;
     float fireInterval_{0};
     bool woundedBird_{false};
     coord_t wbird_mul_{0};
@@ -0,0 +1,190 @@
+/****************************************************************************/
+/*                                                                          */
+/*   HIEMALIA SOURCE CODE (C) 2021      SAMPO HIPPELAINEN (HISAHI).         */
+/*   SEE THE LICENSE FILE IN THE SOURCE ROOT DIRECTORY FOR LICENSE INFO.    */
+/*                                                                          */
+/****************************************************************************/
+// game/pool.hh: header file for object pools (game/pool.cc)
+
+#ifndef M_GAME_POOL_HH
+#define M_GAME_POOL_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "defs.hh"
+#include "inherit.hh"
+
+namespace hiemalia {
+
+// the slots of a pool are allocated this many at a time
+inline constexpr size_t objectPoolChunk = 64;
+
+// the storage for the objects of one concrete type. slots come in chunks
+// that are kept until exit, so once every type has reached its peak count,
+// making an object does not touch the heap. the generation of a slot
+// changes every time its object is freed. every pool has its own id, counting
+// up from zero
+class ObjectPool {
+  public:
+    ObjectPool(size_t size, size_t align);
+    DELETE_COPY(ObjectPool);
+
+    uint32_t allocate();
+    void free(uint32_t index) noexcept;
+    inline void* at(uint32_t index) const noexcept {
+        return chunks_[index / objectPoolChunk].get() +
+               (index % objectPoolChunk) * size_;
+    }
+    inline uint32_t generation(uint32_t index) const noexcept {
+        return generations_[index];
+    }
+    inline uint32_t id() const noexcept { return id_; }
+
+  private:
+    uint32_t id_;
+    size_t size_;
+    std::vector<std::unique_ptr<unsigned char[]>> chunks_;
+    std::vector<uint32_t> free_;
+    std::vector<uint32_t> generations_;
+};
+
+// never destroyed, so that objects still alive at exit can be freed
+template <typename T>
+ObjectPool& objectPool() {
+    static ObjectPool* pool = new ObjectPool(sizeof(T), alignof(T));
+    return *pool;
+}
+
+template <typename T>
+class PoolPtr;
+
+// refers to a pooled object without owning it. get returns nullptr once the
+// object has been freed, even if its slot has been reused since
+template <typename T>
+class ObjectRef {
+  public:
+    inline T* get() const noexcept {
+        return ptr_ && pool_->generation(index_) == generation_ ? ptr_
+                                                                : nullptr;
+    }
+
+  private:
+    T* ptr_{nullptr};
+    const ObjectPool* pool_{nullptr};
+    uint32_t index_{0};
+    uint32_t generation_{0};
+
+    friend class PoolPtr<T>;
+};
+
+// owns a pooled object like a unique_ptr. T can be a base class of the
+// type the object was made as, and like with shared_ptr, it only has to be
+// complete where the object is made
+template <typename T>
+class PoolPtr {
+  public:
+    inline PoolPtr() noexcept {}
+    inline PoolPtr(std::nullptr_t) noexcept {}
+    inline PoolPtr(PoolPtr&& move) noexcept
+        : ptr_(std::exchange(move.ptr_, nullptr)),
+          pool_(move.pool_),
+          destroy_(move.destroy_),
+          index_(move.index_) {}
+    template <typename U,
+              typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    inline PoolPtr(PoolPtr<U>&& move) noexcept
+        : ptr_(std::exchange(move.ptr_, nullptr)),
+          pool_(move.pool_),
+          destroy_(move.destroy_),
+          index_(move.index_) {}
+    inline PoolPtr& operator=(PoolPtr&& move) noexcept {
+        if (&move != this) {
+            reset();
+            ptr_ = std::exchange(move.ptr_, nullptr);
+            pool_ = move.pool_;
+            destroy_ = move.destroy_;
+            index_ = move.index_;
+        }
+        return *this;
+    }
+    PoolPtr(const PoolPtr& copy) = delete;
+    PoolPtr& operator=(const PoolPtr& copy) = delete;
+    inline ~PoolPtr() noexcept { reset(); }
+
+    inline void reset() noexcept {
+        if (ptr_) {
+            ptr_ = nullptr;
+            destroy_(pool_->at(index_));
+            pool_->free(index_);
+        }
+    }
+    inline T* get() const noexcept { return ptr_; }
+    inline T* operator->() const noexcept { return ptr_; }
+    inline T& operator*() const noexcept { return *ptr_; }
+    inline explicit operator bool() const noexcept { return ptr_ != nullptr; }
+    // the pool of the type the object was made as
+    inline const ObjectPool* pool() const noexcept { return pool_; }
+    inline ObjectRef<T> ref() const noexcept {
+        ObjectRef<T> r;
+        if (ptr_) {
+            r.ptr_ = ptr_;
+            r.pool_ = pool_;
+            r.index_ = index_;
+            r.generation_ = pool_->generation(index_);
+        }
+        return r;
+    }
+
+  private:
+    T* ptr_{nullptr};
+    ObjectPool* pool_{nullptr};
+    // calls the destructor of the type the object was made as
+    void (*destroy_)(void*) noexcept {nullptr};
+    uint32_t index_{0};
+
+    inline PoolPtr(T* ptr, ObjectPool* pool, void (*destroy)(void*) noexcept,
+                   uint32_t index) noexcept
+        : ptr_(ptr), pool_(pool), destroy_(destroy), index_(index) {}
+
+    template <typename U>
+    friend class PoolPtr;
+    template <typename U, typename... Ts>
+    friend PoolPtr<U> makePooled(Ts&&... args);
+    template <typename U, typename V>
+    friend PoolPtr<U> poolPtrCast(PoolPtr<V>&& p) noexcept;
+};
+
+// like std::make_shared, but the object goes into objectPool<T>
+template <typename T, typename... Ts>
+PoolPtr<T> makePooled(Ts&&... args) {
+    ObjectPool& pool = objectPool<T>();
+    uint32_t index = pool.allocate();
+    T* ptr;
+    try {
+        ptr = new (pool.at(index)) T(std::forward<Ts>(args)...);
+    } catch (...) {
+        pool.free(index);
+        throw;
+    }
+    return PoolPtr<T>(
+        ptr, &pool, [](void* p) noexcept { static_cast<T*>(p)->~T(); },
+        index);
+}
+
+// like std::dynamic_pointer_cast. p keeps the object if the cast fails
+template <typename U, typename V>
+PoolPtr<U> poolPtrCast(PoolPtr<V>&& p) noexcept {
+    U* ptr = dynamic_cast<U*>(p.ptr_);
+    if (!ptr) return nullptr;
+    p.ptr_ = nullptr;
+    return PoolPtr<U>(ptr, p.pool_, p.destroy_, p.index_);
+}
+};  // namespace hiemalia
+
+#endif  // M_GAME_POOL_HH
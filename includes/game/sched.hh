@@ -0,0 +1,84 @@
+/****************************************************************************/
+/*                                                                          */
+/*   HIEMALIA SOURCE CODE (C) 2021      SAMPO HIPPELAINEN (HISAHI).         */
+/*   SEE THE LICENSE FILE IN THE SOURCE ROOT DIRECTORY FOR LICENSE INFO.    */
+/*                                                                          */
+/****************************************************************************/
+// game/sched.hh: header file for the object update loops (game/sched.cc)
+
+#ifndef M_GAME_SCHED_HH
+#define M_GAME_SCHED_HH
+
+#include <vector>
+
+#include "defs.hh"
+#include "game/object.hh"
+#include "game/pool.hh"
+#include "model.hh"
+#include "rend3d.hh"
+#include "sbuf.hh"
+
+namespace hiemalia {
+
+class GameWorld;
+
+// draws objects in order. consecutive objects with the same instanceModel
+// are drawn at once
+class ObjectDrawer {
+  public:
+    ObjectDrawer();
+    inline void draw(SplinterBuffer& sbuf, Renderer3D& r3d, GameObject& obj) {
+        const Model* m = obj.instanceModel();
+        if (m)
+            add(sbuf, r3d, obj, *m);
+        else {
+            flush(sbuf, r3d);
+            obj.render(sbuf, r3d);
+        }
+    }
+    // draw without the virtual calls; T must be the type obj was made as
+    template <typename T>
+    inline void drawAs(SplinterBuffer& sbuf, Renderer3D& r3d, T& obj) {
+        const Model* m = obj.T::instanceModel();
+        if (m)
+            add(sbuf, r3d, obj, *m);
+        else {
+            flush(sbuf, r3d);
+            obj.T::render(sbuf, r3d);
+        }
+    }
+    // draws m as if it were the model of an object at t
+    void drawInstance(SplinterBuffer& sbuf, Renderer3D& r3d, const Model& m,
+                      const ModelTransform& t);
+    void flush(SplinterBuffer& sbuf, Renderer3D& r3d);
+
+  private:
+    std::vector<ModelTransform> instances_;
+    const Model* model_{nullptr};
+
+    void add(SplinterBuffer& sbuf, Renderer3D& r3d, const GameObject& obj,
+             const Model& m);
+};
+
+// what ticking and drawing the objects of one list needs
+struct ObjectPass {
+    GameWorld& world;
+    float delta;
+    SplinterBuffer& sbuf;
+    Renderer3D& r3d;
+    ObjectDrawer& drawer;
+    // objects at or behind this z are not drawn
+    coord_t lateZ;
+};
+
+// ticks the objects in [first, last) in order, draws the ones that are
+// still alive and moves them to the front like std::remove_if; returns the
+// new end. a run of objects made in the same pool is updated by a loop
+// made for their type, if the type has one (see game/sched.cc)
+template <typename T>
+PoolPtr<T>* updateObjects(ObjectPass& pass, PoolPtr<T>* first,
+                          PoolPtr<T>* last);
+
+};  // namespace hiemalia
+
+#endif  // M_GAME_SCHED_HH
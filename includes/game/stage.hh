@@ -14,6 +14,7 @@
 
 #include "cbuffer.hh"
 #include "game/object.hh"
+#include "game/pool.hh"
 #include "model.hh"
 #include "rend3d.hh"
 #include "sbuf.hh"
@@ -27,7 +28,7 @@ inline const coord_t stageSectionLength = 1.0 / stageDivision;
 constexpr unsigned stageSpawnDistance = 5;
 
 struct ObjectSpawn {
-    std::shared_ptr<GameObject> obj;
+    PoolPtr<GameObject> obj;
     bool isEnemy;
     unsigned pos_i;
     coord_t pos_f;
@@ -50,6 +51,35 @@ struct GameSection {
 
 GameSection loadSection(const std::string& name);
 
+// the models of the visible sections, already moved to their place along z,
+// in one array. sections are added to the back and dropped from the front
+// as the stage scrolls, so each section is transformed only once
+class StageGeometry {
+  public:
+    StageGeometry();
+    void push(const Model& model);
+    void render(SplinterBuffer& sbuf, Renderer3D& r3d, coord_t z) const;
+
+  private:
+    struct SectionSize {
+        size_t vertices;
+        size_t shapes;
+    };
+
+    VertexLanes vertices_;
+    std::vector<ModelFragment> shapes_;
+    CircularBuffer<SectionSize, stageVisibility> visible_;
+    // point lists of the shapes removed by compact, reused by push
+    std::vector<std::vector<size_t>> sparePoints_;
+    // the dropped sections before these are still in the arrays until the
+    // next compact
+    size_t vertexBase_{0};
+    size_t shapeBase_{0};
+    // sections since the z origin of vertices_, including the visible ones
+    size_t pushed_{0};
+    void compact();
+};
+
 class GameStage {
   public:
     using visible_type = CircularBuffer<section_t, stageVisibility>;
@@ -61,7 +91,7 @@ class GameStage {
     void enterBossLoop(std::initializer_list<section_t> loop);
     void exitBossLoop();
     void doOverride(std::initializer_list<section_t> sec);
-    inline const visible_type visible() const noexcept { return visible_; }
+    inline const visible_type& visible() const noexcept { return visible_; }
     bool shouldSpawnNext(unsigned i, coord_t f) const;
     ObjectSpawn spawnNext();
 
@@ -70,8 +100,10 @@ class GameStage {
               std::deque<ObjectSpawn>&& spawns);
     static void processSectionCommand(std::vector<section_t>& sections,
                                       const std::string& s);
+    void pushVisible(section_t section);
     std::deque<ObjectSpawn> spawns_;
     visible_type visible_;
+    StageGeometry geometry_;
     std::vector<section_t> sections_;
     std::vector<section_t> sectionsLoop_;
     size_t nextSection_{0};
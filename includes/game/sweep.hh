@@ -0,0 +1,85 @@
+/****************************************************************************/
+/*                                                                          */
+/*   HIEMALIA SOURCE CODE (C) 2021      SAMPO HIPPELAINEN (HISAHI).         */
+/*   SEE THE LICENSE FILE IN THE SOURCE ROOT DIRECTORY FOR LICENSE INFO.    */
+/*                                                                          */
+/****************************************************************************/
+// game/sweep.hh: header file for the collision broadphase (game/sweep.cc)
+
+#ifndef M_GAME_SWEEP_HH
+#define M_GAME_SWEEP_HH
+
+#include <cstdint>
+#include <vector>
+
+#include "defs.hh"
+#include "game/object.hh"
+#include "stats.hh"
+
+namespace hiemalia {
+
+// sorts the objects of one list by the z range returned by sweepZMin and
+// sweepZMax, so that only the objects whose range overlaps another one need
+// to be tested with hits. the tunnel is long and narrow, so z separates
+// objects far better than x or y would.
+// the index is built on the first query after invalidate and stays valid as
+// long as the objects in the list do not move; objects added to the end of
+// the list after that are always returned
+class ObjectSweep {
+  public:
+    ObjectSweep();
+
+    inline void invalidate() noexcept { valid_ = false; }
+
+    // calls f for every element of list that might hit o, in list order.
+    // list must be the same list every time (until invalidate)
+    template <typename List, typename F>
+    void forEach(List& list, const GameObject& o, F&& f) {
+        size_t n = list.size();
+        if (busy_) {
+            // a query from inside f; the candidate buffer is in use
+            perfStats.add(Stat::CollisionPairs, n);
+            for (size_t i = 0; i < n; ++i) f(list[i]);
+            return;
+        }
+        if (!valid_ || n < size_) {
+            clear();
+            for (size_t i = 0; i < n; ++i)
+                insert(i, list[i]->sweepZMin(), list[i]->sweepZMax());
+            finish();
+        }
+        query(o.sweepZMin(), o.sweepZMax(), n);
+        perfStats.add(Stat::CollisionPairs, hits_.size());
+        busy_ = true;
+        for (uint32_t i : hits_) f(list[i]);
+        busy_ = false;
+    }
+
+  private:
+    struct Entry {
+        coord_t z0;
+        coord_t z1;
+        uint32_t index;
+    };
+
+    // sorted by z0
+    std::vector<Entry> entries_;
+    // the largest z1 of entries_[0..i], for finding where a query starts
+    std::vector<coord_t> reach_;
+    // entries too long to keep in entries_ without making every query
+    // start early (such as objects that have not moved yet)
+    std::vector<Entry> wide_;
+    std::vector<uint32_t> hits_;
+    size_t size_{0};
+    bool valid_{false};
+    bool busy_{false};
+
+    void clear();
+    void insert(size_t index, coord_t z0, coord_t z1);
+    void finish();
+    void query(coord_t z0, coord_t z1, size_t n);
+};
+
+};  // namespace hiemalia
+
+#endif  // M_GAME_SWEEP_HH
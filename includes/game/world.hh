@@ -10,14 +10,18 @@
 #define M_GAME_WORLD_HH
 
 #include <memory>
+#include <type_traits>
 #include <vector>
 
 #include "game/bullet.hh"
+#include "game/bullets.hh"
 #include "game/diffic.hh"
 #include "game/explode.hh"
 #include "game/object.hh"
 #include "game/player.hh"
+#include "game/pool.hh"
 #include "game/stage.hh"
+#include "game/sweep.hh"
 #include "gconfig.hh"
 #include "lvector.hh"
 
@@ -31,8 +35,9 @@ constexpr int defaultLives = 3;
 inline const coord_t farObjectBackPlane =
     static_cast<coord_t>(1 * stageSpawnDistance);
 
+// the objects are kept in pools (see ObjectPool); the lists own them
 template <typename T>
-using ObjectPtrBase = std::shared_ptr<T>;
+using ObjectPtrBase = PoolPtr<T>;
 template <typename T>
 using ObjectListBase = LimitedVector<ObjectPtrBase<T>, objectsMax>;
 using ObjectPtr = ObjectPtrBase<GameObject>;
@@ -67,16 +72,32 @@ class GameWorld {
     coord_t getObjectBackPlane() const;
     Orient3D getSectionRotation() const;
     Point3D rotateInSection(Point3D v, coord_t z) const;
-    std::unique_ptr<PlayerObject>&& explodePlayer(
-        std::unique_ptr<Explosion>&& expl);
+    std::unique_ptr<PlayerObject>&& explodePlayer(ParticleHandle expl);
     void explodeEnemy(GameObject& enemy, const Model& model);
     void explodeBoss(GameObject& enemy, const Model& model);
     void explodeBullet(BulletObject& bullet);
     const Point3D& getPlayerPosition();
+    ParticleSystem& getParticles();
     bool respawn();
     const EnemyList& getEnemies() const;
     const BulletList& getPlayerBullets() const;
     const BulletList& getEnemyBullets() const;
+    // the simple enemy bullets, which are not in getEnemyBullets
+    BulletSystem& getBulletSystem();
+    // calls f for the objects of getEnemies, getPlayerBullets or
+    // getEnemyBullets (or the bullets of getBulletSystem) that might hit o
+    // (see ObjectSweep)
+    template <typename T, typename F>
+    void forEachNear(const ObjectListBase<T>& list, const GameObject& o,
+                     F&& f) {
+        sweepOf(list).forEach(list, o, std::forward<F>(f));
+    }
+    template <typename F>
+    void forEachNear(BulletSystem& bullets, const GameObject& o, F&& f) {
+        bulletSystemSweep_.forEach(bullets, o, std::forward<F>(f));
+    }
+    // must be called whenever the objects in the lists above may have moved
+    void invalidateSweeps();
     void setNewSpeed(coord_t s, coord_t d);
     void setCheckpoint(coord_t z);
     void endStage();
@@ -92,40 +113,56 @@ class GameWorld {
     void spendContinue();
     void addCredits(int n);
 
+    // an object that keeps track of another one must do it through the
+    // ObjectRef returned here (or by PoolPtr::ref), never a plain pointer,
+    // since the object is freed at the end of the tick it dies on
     template <typename T, typename... Ts>
-    void spawn(const Point3D& p, Ts&&... args) {
-        auto& o = objects.emplace_back(
-            std::make_shared<T>(p, std::forward<Ts>(args)...));
-        o->onSpawn(*this);
+    ObjectRef<T> spawn(const Point3D& p, Ts&&... args) {
+        return spawnInto<T>(objects, p, std::forward<Ts>(args)...);
     }
     template <typename T, typename... Ts>
-    void spawnEnemy(const Point3D& p, Ts&&... args) {
-        auto& o = enemies.emplace_back(
-            std::make_shared<T>(p, std::forward<Ts>(args)...));
-        o->onSpawn(*this);
+    ObjectRef<T> spawnEnemy(const Point3D& p, Ts&&... args) {
+        return spawnInto<T>(enemies, p, std::forward<Ts>(args)...);
     }
     template <typename T, typename... Ts>
-    void firePlayerBullet(const Point3D& p, Ts&&... args) {
-        auto& b = playerBullets.emplace_back(
-            std::make_shared<T>(p, std::forward<Ts>(args)...));
-        b->onSpawn(*this);
+    ObjectRef<T> firePlayerBullet(const Point3D& p, Ts&&... args) {
+        return spawnInto<T>(playerBullets, p, std::forward<Ts>(args)...);
     }
+    // T is a BulletObject or one of the bullets of the BulletSystem (see
+    // game/ebullet.hh)
     template <typename T, typename... Ts>
     void fireEnemyBullet(const Point3D& p, const Point3D& v, Ts&&... args) {
-        auto& b = enemyBullets.emplace_back(
-            std::make_shared<T>(p, v, std::forward<Ts>(args)...));
-        b->onSpawn(*this);
+        if constexpr (std::is_base_of_v<BulletObject, T>) {
+            auto& b = enemyBullets.emplace_back(
+                makePooled<T>(p, v, std::forward<Ts>(args)...));
+            b->onSpawn(*this);
+        } else
+            T::fire(bulletSystem_, p, v, std::forward<Ts>(args)...);
     }
 
   private:
+    template <typename T, typename List, typename... Ts>
+    ObjectRef<T> spawnInto(List& list, const Point3D& p, Ts&&... args) {
+        PoolPtr<T> o = makePooled<T>(p, std::forward<Ts>(args)...);
+        ObjectRef<T> ref = o.ref();
+        list.emplace_back(std::move(o))->onSpawn(*this);
+        return ref;
+    }
+
     ConfigSectionPtr<GameConfig> config_;
     std::unique_ptr<PlayerObject> player;
-    std::unique_ptr<Explosion> playerExplosion;
+    ParticleHandle playerExplosion;
     std::unique_ptr<GameStage> stage;
     ObjectList objects;
+    ParticleSystem particles;
     EnemyList enemies;
     BulletList playerBullets;
     BulletList enemyBullets;
+    BulletSystem bulletSystem_;
+    ObjectSweep enemySweep_;
+    ObjectSweep playerBulletSweep_;
+    ObjectSweep enemyBulletSweep_;
+    ObjectSweep bulletSystemSweep_;
     unsigned sections{0};
     coord_t checkpoint{0};
     coord_t progress_f{0};
@@ -151,6 +188,8 @@ class GameWorld {
     GameDifficulty difficulty_;
 
     void moveForwardSkip(coord_t dist);
+    ObjectSweep& sweepOf(const EnemyList& list);
+    ObjectSweep& sweepOf(const BulletList& list);
 
     friend class GameMain;
 };
@@ -25,6 +25,8 @@ class HostModule : public Module {
     virtual void finish() = 0;
     // enable code for quit through Alt+F4
     virtual void arcade() = 0;
+    // true if there is no window, sound or input (see --headless)
+    virtual bool headless() const noexcept { return false; }
 
     DELETE_COPY(HostModule);
     INHERIT_MOVE(HostModule, Module);
@@ -37,7 +39,28 @@ class HostModule : public Module {
     static inline const std::string role_ = "host module";
 };
 
-std::shared_ptr<HostModule> getHostModule();
+// runs as fast as it can, never waits for anything
+class HostModuleNull : public HostModule {
+  public:
+    inline std::string name() const noexcept { return name_; }
+    inline void begin() {}
+    inline bool proceed() { return !quit_; }
+    inline void quit() { quit_ = true; }
+    inline void finish() { quit_ = true; }
+    inline void arcade() {}
+    inline bool headless() const noexcept { return true; }
+
+    inline HostModuleNull() {}
+    DELETE_COPY(HostModuleNull);
+    INHERIT_MOVE(HostModuleNull, HostModule);
+    inline ~HostModuleNull() noexcept {}
+
+  private:
+    static inline const std::string name_ = "HostModuleNull";
+    bool quit_{false};
+};
+
+std::shared_ptr<HostModule> getHostModule(bool headless = false);
 void hostDisplayError(const std::string& title, const std::string& text);
 
 };  // namespace hiemalia
@@ -108,6 +108,8 @@ class Hiemalia : MessageHandler<HostMessage> {
     int credits_{0};
 
     void resetArcade();
+    void runPipelined();
+    void runHeadless();
 };
 
 extern "C" int hiemalia_tryAddCredits(int);
@@ -13,6 +13,8 @@
 
 #include "buttons.hh"
 #include "config.hh"
+#include "controls.hh"
+#include "defs.hh"
 #include "hbase.hh"
 #include "inherit.hh"
 #include "module.hh"
@@ -84,6 +86,36 @@ class InputControlModule : public Module {
     static inline const std::string role_ = "input control module";
 };
 
+// no devices; every control always reads as released
+class InputModuleNull : public InputModule {
+  public:
+    inline std::string name() const noexcept { return name_; }
+
+    inline void update(ControlState& state, MenuControlState& menustate,
+                       float interval) {
+        state.update(state_);
+        menustate.update(menustate_, interval);
+    }
+    inline bool hasInputDevice(InputDevice device) const { return false; }
+    inline InputControlModule& getInputDevice(InputDevice device) {
+        never("null input module has no devices");
+    }
+    inline InputControlModule& addInputDevice(
+        InputDevice device, const ConfigSectionPtr<ButtonSetup>& config) {
+        never("null input module has no devices");
+    }
+
+    inline explicit InputModuleNull(const std::shared_ptr<HostModule>& host) {}
+    DELETE_COPY(InputModuleNull);
+    INHERIT_MOVE(InputModuleNull, InputModule);
+    inline ~InputModuleNull() noexcept {}
+
+  private:
+    static inline const std::string name_ = "InputModuleNull";
+    ControlState state_;
+    MenuControlState menustate_;
+};
+
 std::shared_ptr<InputModule> getInputModule(
     const std::shared_ptr<HostModule>& host);
 
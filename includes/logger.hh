@@ -28,6 +28,7 @@ class LogHandler {
     LogHandler& operator=(LogHandler&& move) = default;
     virtual void handle(LogLevel level, const std::tm& tm, const char* file,
                         size_t line, const std::string& msg) = 0;
+    virtual bool accepts(LogLevel level) const noexcept = 0;
     virtual ~LogHandler() {}
 
   protected:
@@ -39,6 +40,9 @@ class StdLogHandler : public LogHandler {
     StdLogHandler(LogLevel minimumLevel) : minimumLevel_(minimumLevel) {}
     void handle(LogLevel level, const std::tm& tm, const char* file,
                 size_t line, const std::string& msg) override;
+    inline bool accepts(LogLevel level) const noexcept override {
+        return level >= minimumLevel_;
+    }
     ~StdLogHandler() {}
 
   private:
@@ -52,6 +56,9 @@ class FileLogHandler : public LogHandler {
         : stream_(std::move(stream)), minimumLevel_(minimumLevel) {}
     void handle(LogLevel level, const std::tm& tm, const char* file,
                 size_t line, const std::string& msg) override;
+    inline bool accepts(LogLevel level) const noexcept override {
+        return level >= minimumLevel_;
+    }
     ~FileLogHandler() {}
 
   private:
@@ -105,6 +112,14 @@ class Logger {
         log(file, line, LogLevel::FAIL, fmt, std::forward<Ts>(args)...);
     }
 
+    // whether any handler prints messages of this level. the macros below
+    // check this first, so that a message nobody prints is not formatted
+    inline bool accepts(LogLevel level) const noexcept {
+        for (const auto& handler : handlers_)
+            if (handler->accepts(level)) return true;
+        return false;
+    }
+
     template <typename T, typename... Ts>
     void addHandler(Ts&&... args) {
         handlers_.emplace_back(std::make_unique<T>(std::forward<Ts>(args)...));
@@ -122,18 +137,30 @@ extern Logger logger;
 extern bool logger_ok;
 
 #define LOG_ADD_HANDLER(T, ...) logger.addHandler<T>(__VA_ARGS__)
-#define LOG_TRACE(...) \
-    (logger_ok ? logger.trace(__FILE__, __LINE__, __VA_ARGS__) : (void)0)
-#define LOG_DEBUG(...) \
-    (logger_ok ? logger.debug(__FILE__, __LINE__, __VA_ARGS__) : (void)0)
-#define LOG_INFO(...) \
-    (logger_ok ? logger.info(__FILE__, __LINE__, __VA_ARGS__) : (void)0)
-#define LOG_WARN(...) \
-    (logger_ok ? logger.warn(__FILE__, __LINE__, __VA_ARGS__) : (void)0)
-#define LOG_ERROR(...) \
-    (logger_ok ? logger.error(__FILE__, __LINE__, __VA_ARGS__) : (void)0)
-#define LOG_FAIL(...) \
-    (logger_ok ? logger.fail(__FILE__, __LINE__, __VA_ARGS__) : (void)0)
+#define LOG_TRACE(...)                                   \
+    (logger_ok && logger.accepts(LogLevel::TRACE)        \
+         ? logger.trace(__FILE__, __LINE__, __VA_ARGS__) \
+         : (void)0)
+#define LOG_DEBUG(...)                                   \
+    (logger_ok && logger.accepts(LogLevel::DEBUG)        \
+         ? logger.debug(__FILE__, __LINE__, __VA_ARGS__) \
+         : (void)0)
+#define LOG_INFO(...)                                   \
+    (logger_ok && logger.accepts(LogLevel::INFO)        \
+         ? logger.info(__FILE__, __LINE__, __VA_ARGS__) \
+         : (void)0)
+#define LOG_WARN(...)                                   \
+    (logger_ok && logger.accepts(LogLevel::WARN)        \
+         ? logger.warn(__FILE__, __LINE__, __VA_ARGS__) \
+         : (void)0)
+#define LOG_ERROR(...)                                   \
+    (logger_ok && logger.accepts(LogLevel::ERROR)        \
+         ? logger.error(__FILE__, __LINE__, __VA_ARGS__) \
+         : (void)0)
+#define LOG_FAIL(...)                                   \
+    (logger_ok && logger.accepts(LogLevel::FAIL)        \
+         ? logger.fail(__FILE__, __LINE__, __VA_ARGS__) \
+         : (void)0)
 };  // namespace hiemalia
 
 #endif  // M_LOGGER_HH
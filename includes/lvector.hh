@@ -175,8 +175,15 @@ class LimitedVector {
         return data_[index];
     }
 
+    const_reference at(size_type index) const {
+        if (index >= count_) throw std::out_of_range("index");
+        return data_[index];
+    }
+
     reference operator[](size_type index) { return data_[index]; }
 
+    const_reference operator[](size_type index) const { return data_[index]; }
+
     reference front() {
         dynamic_assert(count_ > 0, "front() on empty LimitedVector");
         return data_[0];
@@ -189,6 +196,8 @@ class LimitedVector {
 
     pointer data() noexcept { return data_; }
 
+    const_pointer data() const noexcept { return data_; }
+
     iterator begin() noexcept { return get_iterator_(0); }
 
     const_iterator begin() const noexcept { return get_const_iterator_(0); }
@@ -11,6 +11,7 @@
 
 #include <array>
 #include <string>
+#include <vector>
 
 #include "cbuffer.hh"
 #include "defs.hh"
@@ -47,6 +48,7 @@ class MenuMain : public Menu {
     Renderer3D rend_;
     coord_t angle_{0};
     CircularBuffer<coord_t, 512> rots_;
+    std::vector<ModelTransform> tubes_;
     ShapeSheet logoSheet;
     SplinterBuffer copyright;
     int nextScreen_{0};
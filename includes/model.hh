@@ -9,6 +9,7 @@
 #ifndef M_MODEL_HH
 #define M_MODEL_HH
 
+#include <algorithm>
 #include <vector>
 
 #include "defs.hh"
@@ -197,14 +198,98 @@ struct ModelFragment {
         : color(color), start(start), points(std::move(points)) {}
 };
 
+// structure-of-arrays copy of model vertices for the projection kernels
+struct VertexLanes {
+    std::vector<coord_t> x;
+    std::vector<coord_t> y;
+    std::vector<coord_t> z;
+
+    VertexLanes() : x(), y(), z() {}
+    explicit VertexLanes(const std::vector<Point3D>& v) : VertexLanes() {
+        assign(v);
+    }
+
+    inline size_t size() const noexcept { return x.size(); }
+    inline void resize(size_t n) {
+        x.resize(n);
+        y.resize(n);
+        z.resize(n);
+    }
+    inline void reserve(size_t n) {
+        x.reserve(n);
+        y.reserve(n);
+        z.reserve(n);
+    }
+    inline void assign(const std::vector<Point3D>& v) {
+        size_t n = v.size();
+        x.resize(n);
+        y.resize(n);
+        z.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            x[i] = v[i].x;
+            y[i] = v[i].y;
+            z[i] = v[i].z;
+        }
+    }
+};
+
+// model-space bounding volumes. the sphere is centered on the box
+struct ModelBounds {
+    Point3D min;
+    Point3D max;
+    Point3D center;
+    coord_t radius;
+
+    ModelBounds()
+        : min(Point3D::origin),
+          max(Point3D::origin),
+          center(Point3D::origin),
+          radius(0) {}
+    explicit ModelBounds(const std::vector<Point3D>& v) : ModelBounds() {
+        compute(v);
+    }
+
+    inline void compute(const std::vector<Point3D>& v) {
+        if (v.empty()) {
+            *this = ModelBounds();
+            return;
+        }
+        min = max = v[0];
+        for (const Point3D& p : v) {
+            min.x = std::min(min.x, p.x);
+            min.y = std::min(min.y, p.y);
+            min.z = std::min(min.z, p.z);
+            max.x = std::max(max.x, p.x);
+            max.y = std::max(max.y, p.y);
+            max.z = std::max(max.z, p.z);
+        }
+        center = Point3D::average(min, max);
+        coord_t r2 = 0;
+        for (const Point3D& p : v)
+            r2 = std::max(r2, (p - center).lengthSquared());
+        radius = sqrt(r2);
+    }
+};
+
 struct Model {
     std::vector<Point3D> vertices;
     std::vector<ModelFragment> shapes;
+    VertexLanes lanes;
+    ModelBounds bounds;
 
-    Model() : vertices(), shapes() {}
+    Model() : vertices(), shapes(), lanes(), bounds() {}
     Model(std::vector<Point3D>&& vertices,
-          std::vector<ModelFragment>&& shapes) noexcept
-        : vertices(std::move(vertices)), shapes(std::move(shapes)) {}
+          std::vector<ModelFragment>&& shapes)
+        : vertices(std::move(vertices)),
+          shapes(std::move(shapes)),
+          lanes(this->vertices),
+          bounds(this->vertices) {}
+
+    // must be called after modifying vertices in place
+    inline void refresh() {
+        lanes.assign(vertices);
+        bounds.compute(vertices);
+    }
 };
 
 };  // namespace hiemalia
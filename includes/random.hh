@@ -19,6 +19,8 @@ using random_engine = std::default_random_engine;
 using random_pool_engine = std::mt19937;
 
 random_engine& getRandomEngine();
+// the engine is seeded from std::random_device unless this is called
+void seedRandomEngine(unsigned seed);
 
 template <typename T>
 auto random(T distr) -> typename T::result_type {
@@ -9,6 +9,8 @@
 #ifndef M_REND3D_HH
 #define M_REND3D_HH
 
+#include <cmath>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -18,6 +20,7 @@
 
 namespace hiemalia {
 static const coord_t viewDistance = 2;
+static const coord_t viewNear = 1.0 / 256;
 
 struct Vector3D {
     coord_t x;
@@ -156,6 +159,46 @@ struct Matrix3D3 {
     }
 };
 
+// a unit quaternion w + xi + yj + zk, for rotations
+struct Quaternion {
+    coord_t w;
+    coord_t x;
+    coord_t y;
+    coord_t z;
+
+    Quaternion(coord_t w, coord_t x, coord_t y, coord_t z)
+        : w(w), x(x), y(y), z(z) {}
+
+    inline static Quaternion identity() { return Quaternion(1, 0, 0, 0); }
+    // the same rotation as Matrix3D3::rotate(r)
+    static Quaternion fromOrient3D(const Orient3D& r);
+    Orient3D toOrient3D() const;
+    // needs no sines or cosines
+    Matrix3D3 toMatrix() const;
+    Point3D rotate(const Point3D& v) const;
+
+    inline Quaternion conjugate() const { return Quaternion(w, -x, -y, -z); }
+    inline coord_t lengthSquared() const {
+        return w * w + x * x + y * y + z * z;
+    }
+    inline Quaternion normalize() const {
+        coord_t f = 1 / std::sqrt(lengthSquared());
+        return Quaternion(w * f, x * f, y * f, z * f);
+    }
+    // the turn made in the time dt at the angular velocity omega (radians
+    // per unit of time around the x, y and z axes). q * step turns q around
+    // its own axes
+    static Quaternion fromAngularVelocity(const Point3D& omega, coord_t dt);
+
+    friend inline Quaternion operator*(const Quaternion& a,
+                                       const Quaternion& b) {
+        return Quaternion(a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+                          a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+                          a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+                          a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w);
+    }
+};
+
 struct Matrix3D {
     coord_t m[16];
 
@@ -297,27 +340,289 @@ struct Matrix3D {
     }
 };
 
+// a Matrix3D whose last row is always 0 0 0 1 (translation, rotation and
+// scale, but no projection). the elements are at the same indices as in
+// Matrix3D
+struct Matrix3DAffine {
+    coord_t m[12];
+
+    Matrix3DAffine() : m{0} {}
+    Matrix3DAffine(coord_t a00, coord_t a01, coord_t a02, coord_t a03,
+                   coord_t a10, coord_t a11, coord_t a12, coord_t a13,
+                   coord_t a20, coord_t a21, coord_t a22, coord_t a23)
+        : m{a00, a01, a02, a03, a10, a11, a12, a13, a20, a21, a22, a23} {}
+    Matrix3DAffine(const Matrix3D3& r, const Point3D& t)
+        : m{r.m[0], r.m[1], r.m[2], t.x, r.m[3], r.m[4], r.m[5], t.y,
+            r.m[6], r.m[7], r.m[8], t.z} {}
+
+    inline coord_t& operator[](size_t i) { return m[i]; }
+    inline const coord_t& operator[](size_t i) const { return m[i]; }
+
+    inline static Matrix3DAffine identity() {
+        return Matrix3DAffine(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0);
+    }
+    inline static Matrix3DAffine translate(const Point3D& p) {
+        return Matrix3DAffine(1, 0, 0, p.x, 0, 1, 0, p.y, 0, 0, 1, p.z);
+    }
+
+    // no division by w, since it is always 1
+    inline Point3D project(const Point3D& p) const {
+        return Point3D(p.x * m[0] + p.y * m[1] + p.z * m[2] + m[3],
+                       p.x * m[4] + p.y * m[5] + p.z * m[6] + m[7],
+                       p.x * m[8] + p.y * m[9] + p.z * m[10] + m[11]);
+    }
+
+    inline bool operator==(const Matrix3DAffine& r) const {
+        for (size_t i = 0; i < 12; ++i)
+            if (m[i] != r.m[i]) return false;
+        return true;
+    }
+
+    inline bool operator!=(const Matrix3DAffine& r) const {
+        return !(*this == r);
+    }
+
+    inline Matrix3DAffine& operator*=(const Matrix3DAffine& r) {
+        *this = *this * r;
+        return *this;
+    }
+    inline Matrix3DAffine& operator*=(const Matrix3D3& r) {
+        *this = *this * r;
+        return *this;
+    }
+
+    friend inline Matrix3DAffine operator*(const Matrix3DAffine& a,
+                                           const Matrix3DAffine& b) {
+        return Matrix3DAffine(
+            a.m[0] * b.m[0] + a.m[1] * b.m[4] + a.m[2] * b.m[8],
+            a.m[0] * b.m[1] + a.m[1] * b.m[5] + a.m[2] * b.m[9],
+            a.m[0] * b.m[2] + a.m[1] * b.m[6] + a.m[2] * b.m[10],
+            a.m[0] * b.m[3] + a.m[1] * b.m[7] + a.m[2] * b.m[11] + a.m[3],
+            a.m[4] * b.m[0] + a.m[5] * b.m[4] + a.m[6] * b.m[8],
+            a.m[4] * b.m[1] + a.m[5] * b.m[5] + a.m[6] * b.m[9],
+            a.m[4] * b.m[2] + a.m[5] * b.m[6] + a.m[6] * b.m[10],
+            a.m[4] * b.m[3] + a.m[5] * b.m[7] + a.m[6] * b.m[11] + a.m[7],
+            a.m[8] * b.m[0] + a.m[9] * b.m[4] + a.m[10] * b.m[8],
+            a.m[8] * b.m[1] + a.m[9] * b.m[5] + a.m[10] * b.m[9],
+            a.m[8] * b.m[2] + a.m[9] * b.m[6] + a.m[10] * b.m[10],
+            a.m[8] * b.m[3] + a.m[9] * b.m[7] + a.m[10] * b.m[11] + a.m[11]);
+    }
+    friend inline Matrix3DAffine operator*(const Matrix3DAffine& a,
+                                           const Matrix3D3& b) {
+        return Matrix3DAffine(
+            a.m[0] * b.m[0] + a.m[1] * b.m[3] + a.m[2] * b.m[6],
+            a.m[0] * b.m[1] + a.m[1] * b.m[4] + a.m[2] * b.m[7],
+            a.m[0] * b.m[2] + a.m[1] * b.m[5] + a.m[2] * b.m[8], a.m[3],
+            a.m[4] * b.m[0] + a.m[5] * b.m[3] + a.m[6] * b.m[6],
+            a.m[4] * b.m[1] + a.m[5] * b.m[4] + a.m[6] * b.m[7],
+            a.m[4] * b.m[2] + a.m[5] * b.m[5] + a.m[6] * b.m[8], a.m[7],
+            a.m[8] * b.m[0] + a.m[9] * b.m[3] + a.m[10] * b.m[6],
+            a.m[8] * b.m[1] + a.m[9] * b.m[4] + a.m[10] * b.m[7],
+            a.m[8] * b.m[2] + a.m[9] * b.m[5] + a.m[10] * b.m[8], a.m[11]);
+    }
+    // (view-)projection times a model matrix. the zeros and the one in the
+    // last row of b are left out: 48 multiplications instead of 64
+    friend inline Matrix3D operator*(const Matrix3D& a,
+                                     const Matrix3DAffine& b) {
+        return Matrix3D(
+            a.m[0] * b.m[0] + a.m[1] * b.m[4] + a.m[2] * b.m[8],
+            a.m[0] * b.m[1] + a.m[1] * b.m[5] + a.m[2] * b.m[9],
+            a.m[0] * b.m[2] + a.m[1] * b.m[6] + a.m[2] * b.m[10],
+            a.m[0] * b.m[3] + a.m[1] * b.m[7] + a.m[2] * b.m[11] + a.m[3],
+            a.m[4] * b.m[0] + a.m[5] * b.m[4] + a.m[6] * b.m[8],
+            a.m[4] * b.m[1] + a.m[5] * b.m[5] + a.m[6] * b.m[9],
+            a.m[4] * b.m[2] + a.m[5] * b.m[6] + a.m[6] * b.m[10],
+            a.m[4] * b.m[3] + a.m[5] * b.m[7] + a.m[6] * b.m[11] + a.m[7],
+            a.m[8] * b.m[0] + a.m[9] * b.m[4] + a.m[10] * b.m[8],
+            a.m[8] * b.m[1] + a.m[9] * b.m[5] + a.m[10] * b.m[9],
+            a.m[8] * b.m[2] + a.m[9] * b.m[6] + a.m[10] * b.m[10],
+            a.m[8] * b.m[3] + a.m[9] * b.m[7] + a.m[10] * b.m[11] + a.m[11],
+            a.m[12] * b.m[0] + a.m[13] * b.m[4] + a.m[14] * b.m[8],
+            a.m[12] * b.m[1] + a.m[13] * b.m[5] + a.m[14] * b.m[9],
+            a.m[12] * b.m[2] + a.m[13] * b.m[6] + a.m[14] * b.m[10],
+            a.m[12] * b.m[3] + a.m[13] * b.m[7] + a.m[14] * b.m[11] +
+                a.m[15]);
+    }
+};
+
+// outcode bits for clip-space points
+enum ClipOutcode : uint8_t {
+    ClipRight = 1 << 0,
+    ClipLeft = 1 << 1,
+    ClipTop = 1 << 2,
+    ClipBottom = 1 << 3,
+    ClipFar = 1 << 4,
+    ClipNear = 1 << 5,
+};
+
+inline uint8_t clipOutcode(coord_t x, coord_t y, coord_t z, coord_t w) {
+    return static_cast<uint8_t>(((x > w) << 0) | ((x < -w) << 1) |
+                                ((y > w) << 2) | ((y < -w) << 3) |
+                                ((z > viewDistance) << 4) |
+                                ((w < viewNear) << 5));
+}
+
+// clip-space vertices (structure-of-arrays) with their outcodes
+struct ProjectedVertices {
+    std::vector<coord_t> x;
+    std::vector<coord_t> y;
+    std::vector<coord_t> z;
+    std::vector<coord_t> w;
+    std::vector<uint8_t> outcode;
+
+    inline size_t size() const noexcept { return x.size(); }
+    inline void resize(size_t n) {
+        x.resize(n);
+        y.resize(n);
+        z.resize(n);
+        w.resize(n);
+        outcode.resize(n);
+    }
+    inline void reserve(size_t n) {
+        x.reserve(n);
+        y.reserve(n);
+        z.reserve(n);
+        w.reserve(n);
+        outcode.reserve(n);
+    }
+    inline Vector3D operator[](size_t i) const {
+        return Vector3D(x[i], y[i], z[i], w[i]);
+    }
+};
+
+// vproj.cc. transforms every vertex in v by m (like Matrix3D::project) and
+// computes the outcodes in the same pass. the SIMD kernels use the same
+// evaluation order without fused multiply-adds; results match the scalar
+// path to within a few ulp of the largest term of each row (the difference
+// comes from the compiler reassociating sums under -Ofast), and outcodes can
+// only differ for points that close to a clip plane. the vertices before
+// first are skipped and their entries in out are left undefined
+void projectVertexLanes(const Matrix3D& m, const VertexLanes& v,
+                        ProjectedVertices& out, size_t first = 0);
+const char* vertexKernelName();
+
 #if !NDEBUG
 std::string printMatrix(const Matrix3D& m);  // test.cc
 #endif
 
+// position, rotation and scale of one instance of a model. if matrix is set,
+// it is the model matrix for them (like from a ModelMatrixCache) and is used
+// instead of building one
+struct ModelTransform {
+    Point3D pos;
+    Orient3D rot;
+    Point3D scale;
+    const Matrix3DAffine* matrix{nullptr};
+};
+
+// one part of a model made of several. drawn with the model matrix of the
+// whole. parts without a model are skipped
+struct ModelPart {
+    const Model* model;
+};
+
 class Renderer3D {
   public:
-    static Matrix3D getModelMatrix(Point3D p, Orient3D r, Point3D s);
+    static Matrix3DAffine getModelMatrix(Point3D p, Orient3D r, Point3D s);
     void renderModel(SplinterBuffer& buf, Point3D p, Orient3D r, Point3D s,
                      const Model& m);
+    // vertices that only need a translation; no culling. only the shapes
+    // from firstShape on are drawn, and they may only use the vertices from
+    // firstVertex on
+    void renderGeometry(SplinterBuffer& buf, Point3D p,
+                        const VertexLanes& vertices,
+                        const std::vector<ModelFragment>& shapes,
+                        size_t firstVertex = 0, size_t firstShape = 0);
+    // mdl must come from getModelMatrix with the scale s
+    void renderModel(SplinterBuffer& buf, const Matrix3DAffine& mdl,
+                     Point3D s, const Model& m);
+    // draws every part with the same model matrix, which is multiplied with
+    // the view matrix only once
+    void renderModels(SplinterBuffer& buf, const Matrix3DAffine& mdl,
+                      Point3D s, const ModelPart* parts, size_t n);
+    // like calling renderModel for every transform, but the vertices of all
+    // instances are projected in one pass
+    void renderInstances(SplinterBuffer& buf, const Model& m,
+                         const ModelTransform* t, size_t n);
+    // n separate lines in one color, the i-th from p0[i] to p1[i] in its own
+    // space that is scaled by s, rotated by r[i] and placed at p[i].
+    // transformed and projected in one batch; no culling
+    void renderLines(SplinterBuffer& buf, size_t n, const Point3D* p,
+                     const Quaternion* r, const Point3D* p0,
+                     const Point3D* p1, Point3D s, Color color);
+    // room for renderLines with up to n lines, so that it does not allocate
+    void reserveLines(size_t n);
     void setCamera(Point3D pos, Orient3D rot, Point3D scale);
     Renderer3D();
 
   private:
-    void renderModelFragment(SplinterBuffer& buf, const ModelFragment& f) const;
-    void projectVertices(const std::vector<Point3D>& v, const Matrix3D& m);
-    static Point3D clipPoint(const Vector3D& onScreen,
-                             const Vector3D& offScreen);
-    bool clipLine(const Vector3D& v0, const Vector3D& v1, Point3D& p0,
-                  Point3D& p1) const;
+    // vertex v of the fragment is at index v + offset of points_
+    void renderModelFragment(SplinterBuffer& buf, const ModelFragment& f,
+                             size_t offset = 0) const;
+    void projectInstances(const VertexLanes& v, size_t n);
+    bool clipLine(size_t i0, size_t i1, Point3D& p0, Point3D& p1,
+                  bool& cut) const;
+    bool isOutsideFrustum(const Point3D& c, coord_t r) const;
+    bool prepareModel(const Matrix3DAffine& mdl, coord_t scale,
+                      const Model& m, const VertexLanes*& lanes);
     Matrix3D view;
-    std::vector<Vector3D> points_;
+    std::vector<Vector3D> frustum_;
+    VertexLanes lanes_;
+    ProjectedVertices points_;
+    static constexpr size_t instanceBlock = 16;
+    // per-instance matrices, element k of instance i at k * instanceBlock + i
+    std::vector<coord_t> instances_;
+};
+
+// an orientation kept as a quaternion. the rotation matrix is only rebuilt
+// when it is needed after the orientation has changed, and setting the same
+// Orient3D again costs no sines or cosines
+class Rotation3D {
+  public:
+    Rotation3D() : q_(Quaternion::identity()) {}
+    explicit Rotation3D(const Quaternion& q) : q_(q) {}
+    explicit Rotation3D(const Orient3D& r) : q_(Quaternion::identity()) {
+        set(r);
+    }
+
+    // returns false if r is the Orient3D that was set last
+    bool set(const Orient3D& r);
+    void set(const Quaternion& q);
+    inline const Quaternion& quaternion() const noexcept { return q_; }
+    inline Orient3D toOrient3D() const { return q_.toOrient3D(); }
+    const Matrix3D3& matrix() const;
+
+    inline Point3D rotate(const Point3D& v, coord_t scale = 1) const {
+        return matrix().project(v) * scale;
+    }
+    inline Point3D direction(coord_t scale = 1) const {
+        const Matrix3D3& m = matrix();
+        return Point3D(m.m[2], m.m[5], m.m[8]) * scale;
+    }
+
+  private:
+    Quaternion q_;
+    Orient3D euler_{0, 0, 0};
+    mutable Matrix3D3 matrix_;
+    bool hasEuler_{false};
+    mutable bool matrixValid_{false};
+};
+
+// keeps the model matrix for the last position, rotation and scale it was
+// asked for, so that rendering and collision in the same tick build it once.
+// the rotation is kept separately, so objects that move without turning
+// need no sines or cosines
+class ModelMatrixCache {
+  public:
+    const Matrix3DAffine& get(const Point3D& p, const Orient3D& r,
+                              const Point3D& s);
+
+  private:
+    Point3D pos_{0, 0, 0};
+    Rotation3D rot_;
+    Point3D scale_{0, 0, 0};
+    Matrix3DAffine mat_;
+    bool valid_{false};
 };
 };  // namespace hiemalia
 
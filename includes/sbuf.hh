@@ -9,7 +9,11 @@
 #ifndef M_VBUF_HH
 #define M_VBUF_HH
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <vector>
 
 #include "defs.hh"
@@ -18,7 +22,7 @@ namespace hiemalia {
 static constexpr size_t DEFAULT_BUFFER_SIZE = 128;
 static constexpr size_t DEFAULT_SCREEN_BUFFER_SIZE = 8192;
 
-enum class SplinterType {
+enum class SplinterType : uint8_t {
     BeginShape,
     Point,
     EndShapePoint,
@@ -38,56 +42,196 @@ struct Color {
 
 struct Splinter {
     SplinterType type;
-    coord_t x;  // between -1.0 (left) ... 1.0 (right)
-    coord_t y;  // between -1.0 (top)  ... 1.0 (bottom)
-    union {
-        int sentinel{0};
-        Color color;
-    };
+    float x;  // between -1.0 (left) ... 1.0 (right)
+    float y;  // between -1.0 (top)  ... 1.0 (bottom)
+    Color color;
 
     Splinter(SplinterType type, coord_t x, coord_t y)
-        : type(type), x(x), y(y) {}
+        : type(type),
+          x(static_cast<float>(x)),
+          y(static_cast<float>(y)),
+          color{0, 0, 0, 0} {}
     Splinter(SplinterType type, coord_t x, coord_t y, Color color)
-        : type(type), x(x), y(y), color(color) {}
+        : type(type),
+          x(static_cast<float>(x)),
+          y(static_cast<float>(y)),
+          color(color) {}
+};
+
+// SplinterBuffer stores splinters packed into 4-byte records. a record is two
+// 15-bit fixed-point coordinates, and the lowest bit of each coordinate holds
+// half of the 2-bit record type. a shape header record is always followed by
+// a raw color record, so the color is stored once per shape
+enum class SplinterRecordType : uint8_t { Point, EndShapePoint, Header, Clip };
+
+union SplinterRecord {
+    struct {
+        int16_t x;
+        int16_t y;
+    } p;
+    Color color;
 };
 
+static_assert(sizeof(SplinterRecord) == 4, "SplinterRecord must be 4 bytes");
+
+static constexpr coord_t splinterFixedScale = 4096;  // range [-4, 4)
+static constexpr int splinterFixedMax = 16383;
+static constexpr int splinterEndClip = -16384;
+
+inline int16_t packSplinterCoord(coord_t c, unsigned bit) {
+    constexpr coord_t lim = splinterFixedMax;
+    // branchless; NaN ends up at -lim
+    coord_t f = std::min(lim, std::max(-lim, c * splinterFixedScale));
+    int v = static_cast<int>(std::lrint(f));
+    return static_cast<int16_t>(v * 2 + static_cast<int>(bit));
+}
+
+inline float unpackSplinterCoord(int16_t c) {
+    return static_cast<float>(c >> 1) *
+           static_cast<float>(1 / splinterFixedScale);
+}
+
+inline SplinterRecordType splinterRecordType(const SplinterRecord& r) {
+    return static_cast<SplinterRecordType>((r.p.x & 1) | ((r.p.y & 1) << 1));
+}
+
 class SplinterBuffer {
   public:
-    using container = std::vector<Splinter>;
-    using const_iterator = container::const_iterator;
+    class const_iterator {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Splinter;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Splinter;
+
+        explicit const_iterator(const SplinterRecord* r)
+            : r_(r), color_{0, 0, 0, 0} {}
+
+        inline Splinter operator*() const {
+            float x = unpackSplinterCoord(r_->p.x);
+            float y = unpackSplinterCoord(r_->p.y);
+            switch (splinterRecordType(*r_)) {
+                case SplinterRecordType::Point:
+                    return Splinter(SplinterType::Point, x, y, color_);
+                case SplinterRecordType::EndShapePoint:
+                    return Splinter(SplinterType::EndShapePoint, x, y, color_);
+                case SplinterRecordType::Header:
+                    return Splinter(SplinterType::BeginShape, x, y,
+                                    r_[1].color);
+                case SplinterRecordType::Clip:
+                    if ((r_->p.x >> 1) == splinterEndClip)
+                        return Splinter(SplinterType::EndClip, 0, 0);
+                    return Splinter(SplinterType::BeginClipCenter, x, y);
+            }
+            never("invalid splinter record");
+        }
+        inline const_iterator& operator++() {
+            if (splinterRecordType(*r_) == SplinterRecordType::Header) {
+                color_ = r_[1].color;
+                r_ += 2;
+            } else {
+                ++r_;
+            }
+            return *this;
+        }
+        inline const_iterator operator++(int) {
+            const_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+        inline bool operator==(const const_iterator& o) const {
+            return r_ == o.r_;
+        }
+        inline bool operator!=(const const_iterator& o) const {
+            return r_ != o.r_;
+        }
+
+      private:
+        const SplinterRecord* r_;
+        Color color_;
+    };
 
-    explicit SplinterBuffer(size_t sz) { _splinters.reserve(sz); }
+    explicit SplinterBuffer(size_t sz) { _records.reserve(sz); }
     SplinterBuffer() : SplinterBuffer(DEFAULT_BUFFER_SIZE) {}
 
     ~SplinterBuffer() = default;
     SplinterBuffer(const SplinterBuffer& copy) = delete;
     SplinterBuffer& operator=(const SplinterBuffer& copy) = delete;
     SplinterBuffer(SplinterBuffer&& move) noexcept
-        : _splinters(std::move(move._splinters)) {}
+        : _records(std::move(move._records)), _count(move._count) {}
     SplinterBuffer& operator=(SplinterBuffer&& move) noexcept {
-        _splinters = std::move(move._splinters);
+        _records = std::move(move._records);
+        _count = move._count;
         return *this;
     }
 
-    inline void clear() noexcept { _splinters.clear(); }
-    inline void push(Splinter splinter) { _splinters.push_back(splinter); }
+    inline void clear() noexcept {
+        _records.clear();
+        _count = 0;
+    }
+    inline void push(const Splinter& splinter) {
+        SplinterRecord r;
+        switch (splinter.type) {
+            case SplinterType::BeginShape:
+                pushPoint(SplinterRecordType::Header, splinter.x, splinter.y);
+                r.color = splinter.color;
+                _records.push_back(r);
+                break;
+            case SplinterType::Point:
+                pushPoint(SplinterRecordType::Point, splinter.x, splinter.y);
+                break;
+            case SplinterType::EndShapePoint:
+                pushPoint(SplinterRecordType::EndShapePoint, splinter.x,
+                          splinter.y);
+                break;
+            case SplinterType::BeginClipCenter:
+                pushPoint(SplinterRecordType::Clip, splinter.x, splinter.y);
+                break;
+            case SplinterType::EndClip:
+                r.p.x = static_cast<int16_t>(splinterEndClip * 2 + 1);
+                r.p.y = 1;
+                _records.push_back(r);
+                break;
+        }
+        ++_count;
+    }
     inline void append(const SplinterBuffer& sbuf) {
-        _splinters.insert(_splinters.end(), sbuf._splinters.begin(),
-                          sbuf._splinters.end());
+        _records.insert(_records.end(), sbuf._records.begin(),
+                        sbuf._records.end());
+        _count += sbuf._count;
     }
     inline void endShape() {
-        dynamic_assert(_splinters.size() > 0, "cannot end non-shape");
-        dynamic_assert(_splinters.back().type == SplinterType::Point,
+        dynamic_assert(_records.size() > 0, "cannot end non-shape");
+        SplinterRecord& r = _records.back();
+        dynamic_assert(splinterRecordType(r) == SplinterRecordType::Point,
                        "cannot end non-shape");
-        _splinters.back().type = SplinterType::EndShapePoint;
+        r.p.x |= 1;
     }
 
-    const_iterator begin() const noexcept { return _splinters.begin(); }
-    const_iterator end() const noexcept { return _splinters.end(); }
-    size_t size() const noexcept { return _splinters.size(); }
+    const_iterator begin() const noexcept {
+        return const_iterator(_records.data());
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(_records.data() + _records.size());
+    }
+    // number of splinters (not records)
+    size_t size() const noexcept { return _count; }
+    size_t bytes() const noexcept {
+        return _records.size() * sizeof(SplinterRecord);
+    }
 
   private:
-    container _splinters;
+    inline void pushPoint(SplinterRecordType t, float x, float y) {
+        unsigned u = static_cast<unsigned>(t);
+        SplinterRecord r;
+        r.p.x = packSplinterCoord(x, u & 1);
+        r.p.y = packSplinterCoord(y, u >> 1);
+        _records.push_back(r);
+    }
+
+    std::vector<SplinterRecord> _records;
+    size_t _count{0};
 };
 };  // namespace hiemalia
 
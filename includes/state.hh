@@ -26,6 +26,9 @@ struct GameState {
     SplinterBuffer sbuf;
     HighScoreTable highScores;
     bool arcade{false};
+    // how the last demo ended; printed by --headless so that runs can be
+    // compared (for example between builds)
+    std::string demoResult;
 };
 
 };  // namespace hiemalia
@@ -0,0 +1,76 @@
+/****************************************************************************/
+/*                                                                          */
+/*   HIEMALIA SOURCE CODE (C) 2021      SAMPO HIPPELAINEN (HISAHI).         */
+/*   SEE THE LICENSE FILE IN THE SOURCE ROOT DIRECTORY FOR LICENSE INFO.    */
+/*                                                                          */
+/****************************************************************************/
+// stats.hh: header file for performance counters
+
+#ifndef M_STATS_HH
+#define M_STATS_HH
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+#include "defs.hh"
+
+namespace hiemalia {
+enum class Stat : size_t {
+    Frames,
+    Splinters,
+    SplinterBytes,
+    LinesUnclipped,
+    LinesClipped,
+    PixelsFilled,
+    DrawCalls,
+    TrigCalls,
+    CollisionPairs,
+    ShapeTransforms,
+    ParticleEmitters,
+    ParticleShards,
+    ParticleBytes,
+    ObjectsPooled,
+    ObjectPoolChunks,
+    ObjectRuns,
+    PeakBullets,
+    LogicMicros,
+    VideoMicros,
+    Count_
+};
+
+template <typename T>
+inline uint64_t microsBetween(const T& t0, const T& t1) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0)
+            .count());
+}
+
+class PerfStats {
+  public:
+    inline void add(Stat s, uint64_t n = 1) noexcept {
+        counters_[static_cast<size_t>(s)] += n;
+    }
+    // for high-water marks
+    inline void peak(Stat s, uint64_t n) noexcept {
+        uint64_t& c = counters_[static_cast<size_t>(s)];
+        if (c < n) c = n;
+    }
+    inline uint64_t get(Stat s) const noexcept {
+        return counters_[static_cast<size_t>(s)];
+    }
+    void reset() noexcept;
+    void report(std::ostream& out) const;
+
+  private:
+    uint64_t counters_[static_cast<size_t>(Stat::Count_)]{};
+};
+
+extern PerfStats perfStats;
+
+// calls to operator new so far. only counted in builds with COUNT_ALLOCS=1,
+// otherwise always zero
+uint64_t heapAllocations() noexcept;
+};  // namespace hiemalia
+
+#endif  // M_STATS_HH
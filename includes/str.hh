@@ -83,6 +83,11 @@ inline std::string substring(const std::string& s, size_t left, size_t right) {
     return right == std::string::npos ? s.substr(left)
                                       : s.substr(left, right - left);
 }
+
+inline bool endsWith(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() &&
+           s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
 };  // namespace hiemalia
 
 #endif  // M_STR_HH
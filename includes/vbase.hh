@@ -35,6 +35,8 @@ class VideoModule : public Module {
     virtual void sync() = 0;
     virtual bool isFullScreen() = 0;
     virtual void setFullScreen(bool flag) = 0;
+    // saves the current frame into an image file; not every backend can
+    virtual bool dumpFrame(const std::string& filename) { return false; }
 
     DELETE_COPY(VideoModule);
     INHERIT_MOVE(VideoModule, Module);
@@ -47,6 +49,29 @@ class VideoModule : public Module {
     static inline const std::string role_ = "video module";
 };
 
+class VideoModuleNull : public VideoModule {
+  public:
+    inline std::string name() const noexcept { return name_; }
+
+    inline bool canSetFullscreen() { return false; }
+
+    inline void frame() {}
+    inline void blank() {}
+    inline void draw(const SplinterBuffer& buffer) {}
+    inline void blit() {}
+    inline void sync() {}
+    inline bool isFullScreen() { return false; }
+    inline void setFullScreen(bool flag) {}
+
+    inline explicit VideoModuleNull(const std::shared_ptr<HostModule>& host) {}
+    DELETE_COPY(VideoModuleNull);
+    INHERIT_MOVE(VideoModuleNull, VideoModule);
+    inline ~VideoModuleNull() noexcept {}
+
+  private:
+    static inline const std::string name_ = "VideoModuleNull";
+};
+
 std::shared_ptr<VideoModule> getVideoModule(
     const std::shared_ptr<HostModule>& host);
 
@@ -9,6 +9,9 @@
 #ifndef M_VIDEO_HH
 #define M_VIDEO_HH
 
+#include <atomic>
+#include <string>
+
 #include "config.hh"
 #include "inherit.hh"
 #include "module.hh"
@@ -18,10 +21,20 @@
 #include "vbase.hh"
 
 namespace hiemalia {
-enum class VideoMessageType { Unused };
+enum class VideoMessageType { DumpFrame };
 
 struct VideoMessage {
     VideoMessageType type;
+    std::string filename;
+
+    // writes the last drawn frame to a .png or .ppm file, if supported
+    inline static VideoMessage dumpFrame(const std::string& filename) {
+        return VideoMessage(VideoMessageType::DumpFrame, filename);
+    }
+
+  private:
+    VideoMessage(VideoMessageType t, const std::string& f)
+        : type(t), filename(f) {}
 };
 
 class VideoConfig : public ConfigSection {
@@ -42,10 +55,17 @@ class VideoEngine : public Module, MessageHandler<VideoMessage> {
     DELETE_COPY(VideoEngine);
 
     VideoEngine(VideoEngine&& move) noexcept
-        : Module(std::move(move)), video_(std::move(move.video_)) {}
+        : Module(std::move(move)),
+          video_(std::move(move.video_)),
+          deferConfig_(move.deferConfig_),
+          fullScreen_(move.fullScreen_.load()),
+          canSetFullScreen_(move.canSetFullScreen_) {}
     VideoEngine& operator=(VideoEngine&& move) noexcept {
         Module::operator=(std::move(move));
         video_ = std::move(move.video_);
+        deferConfig_ = move.deferConfig_;
+        fullScreen_ = move.fullScreen_.load();
+        canSetFullScreen_ = move.canSetFullScreen_;
         return *this;
     }
     VideoEngine(const std::shared_ptr<HostModule>& host, GameState& state);
@@ -54,9 +74,14 @@ class VideoEngine : public Module, MessageHandler<VideoMessage> {
     void frame(const SplinterBuffer& sbuf);
     void sync();
     void readConfig();
-
-    bool isFullScreen();
-    bool canSetFullScreen();
+    // when set, config changes are applied on the next frame() instead
+    inline void deferConfig(bool flag) { deferConfig_ = flag; }
+
+    // these return what the video module said on the main thread (on the
+    // last frame or config change), so that the menus can call them from
+    // the logic worker thread
+    inline bool isFullScreen() const noexcept { return fullScreen_; }
+    inline bool canSetFullScreen() const noexcept { return canSetFullScreen_; }
     void setFullScreenOrElse();
 
     void gotMessage(const VideoMessage& msg);
@@ -65,6 +90,11 @@ class VideoEngine : public Module, MessageHandler<VideoMessage> {
   private:
     std::shared_ptr<VideoModule> video_;
     ConfigSectionPtr<VideoConfig> config_;
+    void applyConfig();
+    bool deferConfig_{false};
+    std::atomic<bool> configPending_{false};
+    std::atomic<bool> fullScreen_{false};
+    bool canSetFullScreen_{false};
     static inline const std::string name_ = "VideoEngine";
     static inline const std::string role_ = "video engine";
 };
@@ -0,0 +1,47 @@
+/****************************************************************************/
+/*                                                                          */
+/*   HIEMALIA SOURCE CODE (C) 2021      SAMPO HIPPELAINEN (HISAHI).         */
+/*   SEE THE LICENSE FILE IN THE SOURCE ROOT DIRECTORY FOR LICENSE INFO.    */
+/*                                                                          */
+/****************************************************************************/
+// worker.hh: header file for worker thread
+
+#ifndef M_WORKER_HH
+#define M_WORKER_HH
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "inherit.hh"
+
+namespace hiemalia {
+// runs one job at a time on a separate thread
+class WorkerThread {
+  public:
+    WorkerThread();
+    ~WorkerThread();
+    DELETE_COPY(WorkerThread);
+    DELETE_MOVE(WorkerThread);
+
+    // starts running the job; the previous one must have been waited for
+    void start(std::function<void()>&& job);
+    // waits for the job to finish and rethrows anything it threw
+    void wait();
+
+  private:
+    void loop();
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::function<void()> job_;
+    std::exception_ptr error_;
+    bool busy_{false};
+    bool quit_{false};
+    std::thread thread_;
+};
+};  // namespace hiemalia
+
+#endif  // M_WORKER_HH
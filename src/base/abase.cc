@@ -25,6 +25,7 @@ namespace hiemalia {
 
 std::shared_ptr<AudioModule> getAudioModule(
     const std::shared_ptr<HostModule>& host) {
+    if (host->headless()) return MAKE_MODULE(AudioModuleNull, host);
 #ifdef ABACKEND_sdl2
     TRY_MODULE("audio", AudioModuleSDLMixer2, std::move(host));
 #endif
@@ -7,6 +7,7 @@
 // base/hbase.cc: implementation of host module getter
 
 #include <exception>
+#include <iostream>
 #include <memory>
 #include <stdexcept>
 
@@ -22,11 +23,19 @@
 
 namespace hiemalia {
 
-std::shared_ptr<HostModule> getHostModule() {
+std::shared_ptr<HostModule> getHostModule(bool headless) {
+    if (headless) return MAKE_MODULE(HostModuleNull);
 #ifdef HBACKEND_sdl2
     TRY_MODULE("host", HostModuleSDL2, );
 #endif
     never("no available host module!");
 }
 
+#ifndef HBACKEND_sdl2
+// headless-only builds have no host backend that can show a message box
+void hostDisplayError(const std::string& title, const std::string& text) {
+    std::cerr << title << ": " << text << std::endl;
+}
+#endif
+
 }  // namespace hiemalia
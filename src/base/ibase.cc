@@ -27,6 +27,7 @@ namespace hiemalia {
 
 std::shared_ptr<InputModule> getInputModule(
     const std::shared_ptr<HostModule>& host) {
+    if (host->headless()) return MAKE_MODULE(InputModuleNull, host);
 #ifdef IBACKEND_sdl2
     TRY_MODULE("input", InputModuleSDL2, std::move(host));
 #endif
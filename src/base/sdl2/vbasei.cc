@@ -10,12 +10,14 @@
 
 #include <algorithm>
 #include <climits>
+#include <cstdlib>
 
 #include "base/sdl2.hh"
 #include "base/sdl2/hbasei.hh"
 #include "defs.hh"
 #include "logger.hh"
 #include "sbuf.hh"
+#include "stats.hh"
 
 namespace hiemalia {
 static int round_down(int x) { return (x / 256) * 256; }
@@ -48,6 +50,9 @@ VideoModuleSDL2::VideoModuleSDL2(VideoModuleSDL2 &&move) noexcept
     : VideoModule(std::move(move)), host_(std::move(move.host_)) {
     std::swap(window_, move.window_);
     std::swap(renderer_, move.renderer_);
+#ifdef VBACKEND_SDL2_GEOMETRY
+    geometry_ = move.geometry_;
+#endif
     onResize();
     host_->addVideoModule(*this);
 }
@@ -61,6 +66,9 @@ VideoModuleSDL2 &VideoModuleSDL2::operator=(VideoModuleSDL2 &&move) noexcept {
     }
     std::swap(window_, move.window_);
     std::swap(renderer_, move.renderer_);
+#ifdef VBACKEND_SDL2_GEOMETRY
+    geometry_ = move.geometry_;
+#endif
     onResize();
     return *this;
 }
@@ -97,6 +105,13 @@ void VideoModuleSDL2::blank() {
 }
 
 void VideoModuleSDL2::draw(const SplinterBuffer &buffer) {
+#ifdef VBACKEND_SDL2_GEOMETRY
+    if (geometry_) return drawGeometry(buffer);
+#endif
+    drawLines(buffer);
+}
+
+void VideoModuleSDL2::drawLines(const SplinterBuffer &buffer) {
     int x, y;
     SDL_RenderSetClipRect(renderer_, &square_);
     for (const auto &s : buffer) {
@@ -118,8 +133,45 @@ void VideoModuleSDL2::draw(const SplinterBuffer &buffer) {
                                "too complex of a shape");
                 SDL_RenderDrawLines(renderer_, points_.data(),
                                     static_cast<int>(points_.size()));
+                perfStats.add(Stat::DrawCalls);
+                break;
+            case SplinterType::BeginClipCenter:
+                x = static_cast<int>(s.x * scale_ + cy_);
+                rect_.x = square_.x;
+                rect_.y = x;
+                rect_.w = square_.w;
+                rect_.h = y - x;
+                SDL_RenderSetClipRect(renderer_, &rect_);
+                break;
+            case SplinterType::EndClip:
+                SDL_RenderSetClipRect(renderer_, &square_);
+                break;
+        }
+    }
+    SDL_RenderSetClipRect(renderer_, nullptr);
+}
+
+#ifdef VBACKEND_SDL2_GEOMETRY
+void VideoModuleSDL2::drawGeometry(const SplinterBuffer &buffer) {
+    int x, y, px = 0, py = 0;
+    SDL_Color color{0, 0, 0, 0};
+    bool ok = true;
+    SDL_RenderSetClipRect(renderer_, &square_);
+    for (const auto &s : buffer) {
+        x = static_cast<int>(s.x * scale_ + cx_);
+        y = static_cast<int>(s.y * scale_ + cy_);
+        switch (s.type) {
+            case SplinterType::BeginShape:
+                color = SDL_Color{s.color.r, s.color.g, s.color.b, s.color.a};
+                break;
+            case SplinterType::Point:
+                addSegment(px, py, x, y, color, false);
+                break;
+            case SplinterType::EndShapePoint:
+                addSegment(px, py, x, y, color, true);
                 break;
             case SplinterType::BeginClipCenter:
+                ok &= flushGeometry();
                 x = static_cast<int>(s.x * scale_ + cy_);
                 rect_.x = square_.x;
                 rect_.y = x;
@@ -128,12 +180,65 @@ void VideoModuleSDL2::draw(const SplinterBuffer &buffer) {
                 SDL_RenderSetClipRect(renderer_, &rect_);
                 break;
             case SplinterType::EndClip:
+                ok &= flushGeometry();
                 SDL_RenderSetClipRect(renderer_, &square_);
                 break;
         }
+        px = x, py = y;
     }
+    ok &= flushGeometry();
     SDL_RenderSetClipRect(renderer_, nullptr);
+    if (!ok) {
+        LOG_WARN("SDL_RenderGeometry failed, drawing lines instead: %s",
+                 SDL_GetError());
+        geometry_ = false;
+        blank();
+        drawLines(buffer);
+    }
+}
+
+// a quad one pixel thick across the minor axis, which covers one pixel per
+// step along the major axis like SDL_RenderDrawLine does. the end point is
+// left out unless this is the last segment, so that the corners of a
+// polyline are not added twice
+void VideoModuleSDL2::addSegment(int x0, int y0, int x1, int y1,
+                                 const SDL_Color &color, bool last) {
+    int dx = x1 - x0, dy = y1 - y0;
+    if (!dx && !dy && !last) return;
+    float ex, ey, ox, oy;
+    if (std::abs(dx) >= std::abs(dy)) {
+        float h = dx < 0 ? -0.5f : 0.5f;
+        ex = h, ey = dx ? h * dy / dx : 0;
+        ox = 0, oy = 0.5f;
+    } else {
+        float h = dy < 0 ? -0.5f : 0.5f;
+        ex = h * dx / dy, ey = h;
+        ox = 0.5f, oy = 0;
+    }
+    float ax = x0 + 0.5f - ex, ay = y0 + 0.5f - ey;
+    float bx = x1 + 0.5f + (last ? ex : -ex);
+    float by = y1 + 0.5f + (last ? ey : -ey);
+    int base = static_cast<int>(vertices_.size());
+    vertices_.push_back(SDL_Vertex{{ax + ox, ay + oy}, color, {0, 0}});
+    vertices_.push_back(SDL_Vertex{{ax - ox, ay - oy}, color, {0, 0}});
+    vertices_.push_back(SDL_Vertex{{bx - ox, by - oy}, color, {0, 0}});
+    vertices_.push_back(SDL_Vertex{{bx + ox, by + oy}, color, {0, 0}});
+    for (int i : {0, 1, 2, 0, 2, 3}) indices_.push_back(base + i);
+}
+
+bool VideoModuleSDL2::flushGeometry() {
+    if (indices_.empty()) return true;
+    dynamic_assert(indices_.size() <= INT_MAX, "too many segments");
+    bool ok = !SDL_RenderGeometry(renderer_, nullptr, vertices_.data(),
+                                  static_cast<int>(vertices_.size()),
+                                  indices_.data(),
+                                  static_cast<int>(indices_.size()));
+    perfStats.add(Stat::DrawCalls);
+    vertices_.clear();
+    indices_.clear();
+    return ok;
 }
+#endif
 
 void VideoModuleSDL2::blit() { SDL_RenderPresent(renderer_); }
 
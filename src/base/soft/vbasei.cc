@@ -0,0 +1,231 @@
+/****************************************************************************/
+/*                                                                          */
+/*   HIEMALIA SOURCE CODE (C) 2021      SAMPO HIPPELAINEN (HISAHI).         */
+/*   SEE THE LICENSE FILE IN THE SOURCE ROOT DIRECTORY FOR LICENSE INFO.    */
+/*                                                                          */
+/****************************************************************************/
+// base/soft/vbasei.cc: implementation of software video module
+
+#include "base/soft/vbasei.hh"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+
+#include "defs.hh"
+#include "file.hh"
+#include "logger.hh"
+#include "sbuf.hh"
+#include "stats.hh"
+#include "str.hh"
+
+namespace hiemalia {
+VideoModuleSoft::VideoModuleSoft(const std::shared_ptr<HostModule>& host,
+                                 int width, int height)
+    : width_(width),
+      height_(height),
+      host_(host),
+      pixels_(static_cast<size_t>(width) * height * 4),
+      chunkX_(chunkSize),
+      chunkY_(chunkSize) {
+    dynamic_assert(width > 0 && height > 0, "invalid framebuffer size");
+    cx_ = width * 0.5;
+    cy_ = height * 0.5;
+    scale_ = std::min(cx_, cy_);
+    square_.x0 = static_cast<int>(cx_ - scale_);
+    square_.x1 = static_cast<int>(cx_ + scale_) - 1;
+    square_.y0 = static_cast<int>(cy_ - scale_);
+    square_.y1 = static_cast<int>(cy_ + scale_) - 1;
+    clip_ = square_;
+    LOG_INFO("software framebuffer is %dx%d", width_, height_);
+}
+
+bool VideoModuleSoft::canSetFullscreen() { return false; }
+
+bool VideoModuleSoft::isFullScreen() { return false; }
+
+void VideoModuleSoft::setFullScreen(bool flag) {}
+
+void VideoModuleSoft::frame() {}
+
+void VideoModuleSoft::blank() {
+    for (size_t i = 0, e = pixels_.size(); i < e; i += 4) {
+        pixels_[i + 0] = 0;
+        pixels_[i + 1] = 0;
+        pixels_[i + 2] = 0;
+        pixels_[i + 3] = 255;
+    }
+}
+
+void VideoModuleSoft::blit() {}
+
+void VideoModuleSoft::sync() {}
+
+// DDA with 16.16 fixed point. the coordinates for a chunk of pixels are
+// generated first in a loop the compiler can vectorize, then blended
+void VideoModuleSoft::drawLine(int x0, int y0, int x1, int y1, const Color& c,
+                               bool last) {
+    int dx = x1 - x0, dy = y1 - y0;
+    int n = std::max(std::abs(dx), std::abs(dy));
+    int count = last ? n + 1 : n;
+    if (count <= 0) return;
+
+    int32_t sx = n ? static_cast<int32_t>((static_cast<int64_t>(dx) << 16) / n)
+                   : 0;
+    int32_t sy = n ? static_cast<int32_t>((static_cast<int64_t>(dy) << 16) / n)
+                   : 0;
+    int32_t fx = (x0 << 16) + 0x8000, fy = (y0 << 16) + 0x8000;
+    // SDL_BLENDMODE_ADD: dstRGB = srcRGB * srcA + dstRGB, dstA = dstA
+    int ar = c.r * c.a / 255, ag = c.g * c.a / 255, ab = c.b * c.a / 255;
+    const ClipRect r = clip_;
+    int32_t* xs = chunkX_.data();
+    int32_t* ys = chunkY_.data();
+    uint64_t filled = 0;
+
+    for (int base = 0; base < count; base += chunkSize) {
+        int m = std::min(chunkSize, count - base);
+        for (int j = 0; j < m; ++j) {
+            xs[j] = (fx + (base + j) * sx) >> 16;
+            ys[j] = (fy + (base + j) * sy) >> 16;
+        }
+        for (int j = 0; j < m; ++j) {
+            int x = xs[j], y = ys[j];
+            if (x < r.x0 || x > r.x1 || y < r.y0 || y > r.y1) continue;
+            uint8_t* p = &pixels_[(static_cast<size_t>(y) * width_ + x) * 4];
+            p[0] = static_cast<uint8_t>(std::min(255, p[0] + ar));
+            p[1] = static_cast<uint8_t>(std::min(255, p[1] + ag));
+            p[2] = static_cast<uint8_t>(std::min(255, p[2] + ab));
+            ++filled;
+        }
+    }
+    perfStats.add(Stat::PixelsFilled, filled);
+}
+
+void VideoModuleSoft::draw(const SplinterBuffer& buffer) {
+    int x, y, px = 0, py = 0;
+    Color color{0, 0, 0, 0};
+    clip_ = square_;
+    for (const auto& s : buffer) {
+        x = static_cast<int>(s.x * scale_ + cx_);
+        y = static_cast<int>(s.y * scale_ + cy_);
+        switch (s.type) {
+            case SplinterType::BeginShape:
+                color = s.color;
+                break;
+            case SplinterType::Point:
+                drawLine(px, py, x, y, color, false);
+                break;
+            case SplinterType::EndShapePoint:
+                drawLine(px, py, x, y, color, true);
+                break;
+            case SplinterType::BeginClipCenter:
+                x = static_cast<int>(s.x * scale_ + cy_);
+                clip_.x0 = square_.x0;
+                clip_.x1 = square_.x1;
+                clip_.y0 = std::max(0, x);
+                clip_.y1 = std::min(height_, y) - 1;
+                break;
+            case SplinterType::EndClip:
+                clip_ = square_;
+                break;
+        }
+        px = x, py = y;
+    }
+}
+
+bool VideoModuleSoft::dumpFrame(const std::string& filename) {
+    if (endsWith(filename, ".png")) return writePNG(filename);
+    if (endsWith(filename, ".ppm")) return writePPM(filename);
+    LOG_WARN("unknown frame dump format for '%s'", filename);
+    return false;
+}
+
+bool VideoModuleSoft::writePPM(const std::string& filename) const {
+    std::ofstream out = openFileWrite(filename, true);
+    if (!out) return false;
+    out << "P6\n" << width_ << " " << height_ << "\n255\n";
+    for (size_t i = 0, e = pixels_.size(); i < e; i += 4)
+        out.write(reinterpret_cast<const char*>(&pixels_[i]), 3);
+    return out.good();
+}
+
+static std::array<uint32_t, 256> makeCrcTable() {
+    std::array<uint32_t, 256> t;
+    for (uint32_t n = 0; n < 256; ++n) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; ++k)
+            c = c & 1 ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+        t[n] = c;
+    }
+    return t;
+}
+
+static uint32_t crc32(uint32_t crc, const uint8_t* p, size_t n) {
+    static const std::array<uint32_t, 256> table = makeCrcTable();
+    crc = ~crc;
+    while (n--) crc = table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void putBE32(std::vector<uint8_t>& v, uint32_t x) {
+    v.push_back(static_cast<uint8_t>(x >> 24));
+    v.push_back(static_cast<uint8_t>(x >> 16));
+    v.push_back(static_cast<uint8_t>(x >> 8));
+    v.push_back(static_cast<uint8_t>(x));
+}
+
+static void writePNGChunk(std::ostream& out, const char* type,
+                          const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> chunk;
+    putBE32(chunk, static_cast<uint32_t>(data.size()));
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    putBE32(chunk, crc32(0, chunk.data() + 4, chunk.size() - 4));
+    out.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+}
+
+// RGB PNG with uncompressed (stored) deflate blocks; no zlib needed
+bool VideoModuleSoft::writePNG(const std::string& filename) const {
+    std::ofstream out = openFileWrite(filename, true);
+    if (!out) return false;
+    static const uint8_t signature[] = {0x89, 'P', 'N', 'G',
+                                        '\r', '\n', 0x1A, '\n'};
+    out.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+    std::vector<uint8_t> ihdr;
+    putBE32(ihdr, static_cast<uint32_t>(width_));
+    putBE32(ihdr, static_cast<uint32_t>(height_));
+    ihdr.insert(ihdr.end(), {8, 2, 0, 0, 0});  // 8-bit RGB
+    writePNGChunk(out, "IHDR", ihdr);
+
+    std::vector<uint8_t> raw;
+    raw.reserve(static_cast<size_t>(height_) * (width_ * 3 + 1));
+    for (int y = 0; y < height_; ++y) {
+        raw.push_back(0);  // no filter
+        const uint8_t* row = &pixels_[static_cast<size_t>(y) * width_ * 4];
+        for (int x = 0; x < width_; ++x)
+            raw.insert(raw.end(), row + x * 4, row + x * 4 + 3);
+    }
+
+    std::vector<uint8_t> z{0x78, 0x01};
+    uint32_t s1 = 1, s2 = 0;
+    for (uint8_t b : raw) {
+        s1 = (s1 + b) % 65521;
+        s2 = (s2 + s1) % 65521;
+    }
+    for (size_t i = 0, e = raw.size(); i < e || i == 0; i += 65535) {
+        size_t n = std::min<size_t>(65535, e - i);
+        z.push_back(i + n >= e ? 1 : 0);
+        z.push_back(static_cast<uint8_t>(n));
+        z.push_back(static_cast<uint8_t>(n >> 8));
+        z.push_back(static_cast<uint8_t>(~n));
+        z.push_back(static_cast<uint8_t>(~n >> 8));
+        z.insert(z.end(), raw.begin() + i, raw.begin() + i + n);
+        if (e == 0) break;
+    }
+    putBE32(z, (s2 << 16) | s1);
+    writePNGChunk(out, "IDAT", z);
+    writePNGChunk(out, "IEND", {});
+    return out.good();
+}
+}  // namespace hiemalia
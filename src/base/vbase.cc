@@ -20,13 +20,25 @@
 #ifdef VBACKEND_sdl2
 #include "base/sdl2/vbasei.hh"
 #endif
+#ifdef VBACKEND_soft
+#include "base/soft/vbasei.hh"
+#endif
 
 namespace hiemalia {
 
 std::shared_ptr<VideoModule> getVideoModule(
     const std::shared_ptr<HostModule>& host) {
+    if (host->headless()) {
+#ifdef VBACKEND_soft
+        TRY_MODULE("video", VideoModuleSoft, std::move(host));
+#endif
+        return MAKE_MODULE(VideoModuleNull, host);
+    }
 #ifdef VBACKEND_sdl2
     TRY_MODULE("video", VideoModuleSDL2, std::move(host));
+#endif
+#ifdef VBACKEND_soft
+    TRY_MODULE("video", VideoModuleSoft, std::move(host));
 #endif
     never("no available video module!");
 }
@@ -0,0 +1,317 @@
+/****************************************************************************/
+/*                                                                          */
+/*   HIEMALIA SOURCE CODE (C) 2021      SAMPO HIPPELAINEN (HISAHI).         */
+/*   SEE THE LICENSE FILE IN THE SOURCE ROOT DIRECTORY FOR LICENSE INFO.    */
+/*                                                                          */
+/****************************************************************************/
+// game/bench.cc: implementation of game logic benchmarks
+
+#include "game/bench.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "game/bullets.hh"
+#include "game/ebullet.hh"
+#include "game/pbullet.hh"
+#include "game/sweep.hh"
+#include "game/world.hh"
+#include "models.hh"
+#include "random.hh"
+#include "rend3d.hh"
+#include "stats.hh"
+#include "str.hh"
+
+namespace hiemalia {
+
+// stands in for the enemies and obstacles that bullets are tested against
+class BenchTarget : public GameObject {
+  public:
+    BenchTarget(const Point3D& pos, GameModel model) : GameObject(pos) {
+        useGameModel(model);
+    }
+};
+
+// EnemyBullet as it was before BulletSystem, when every bullet was an object
+class BenchBullet : public BulletObject {
+  public:
+    BenchBullet(const Point3D& pos, const Point3D& v) : BulletObject(pos) {
+        useGameModel(GameModel::BulletEnemy);
+        vel = v;
+        rotvel = Orient3D(1.8, 1.2, 0.6) * 16;
+    }
+    bool doBulletTick(GameWorld& w, float delta) {
+        doMove(delta);
+        rot += rotvel;
+        if (!w.isPlayerAlive()) return true;
+        SweepImpact hit = impactOn(w.getPlayer());
+        if (hit.hit) {
+            if (w.getPlayer().playerInControl())
+                w.getPlayer().damage(w, getDamage(), hit.contact);
+            impact(w, false);
+        }
+        return true;
+    }
+    void impact(GameWorld& w, bool enemy) {
+        if (!enemy) w.explodeBullet(*this);
+        kill(w);
+    }
+    bool firedByPlayer() const { return false; }
+    float getDamage() const { return 1.0f; }
+};
+
+static const int benchFrames = 600;
+// the objects of both kinds, together close to objectsMax
+static const int benchObjects = objectsMax / 2;
+
+static coord_t uniform(coord_t a, coord_t b) {
+    return random(std::uniform_real_distribution<coord_t>(a, b));
+}
+
+// every frame, every bullet moves and is then tested against every target
+// (as in PlayerBullet) and every target against every bullet (as in
+// Obstacle), once by brute force and once through ObjectSweep
+static void benchBroadphase(std::ostream& out) {
+    ObjectList targets;
+    BulletList bullets;
+    for (int i = 0; i < benchObjects; ++i) {
+        auto t = makePooled<BenchTarget>(
+            Point3D(uniform(-1, 1), uniform(-1, 1),
+                    uniform(0, farObjectBackPlane)),
+            i % 2 ? GameModel::EnemyChevron : GameModel::EnemyFighter);
+        t->rot = Orient3D(uniform(-1, 1), uniform(-1, 1), uniform(-1, 1));
+        targets.push_back(std::move(t));
+        bullets.push_back(makePooled<PlayerBullet>(
+            Point3D(uniform(-1, 1), uniform(-1, 1),
+                    uniform(0, farObjectBackPlane)),
+            Point3D(0, 0, 6)));
+    }
+
+    ObjectSweep targetSweep, bulletSweep;
+    unsigned long long bruteHits = 0, sweepHits = 0;
+    uint64_t bruteMicros = 0, sweepMicros = 0;
+    uint64_t pairs = perfStats.get(Stat::CollisionPairs);
+    for (int frame = 0; frame < benchFrames; ++frame) {
+        for (auto& b : bullets) {
+            Point3D p = b->pos + b->vel * tickInterval;
+            if (p.z > farObjectBackPlane) p.z -= farObjectBackPlane;
+            b->setPosition(p);
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+        for (const auto& b : bullets)
+            for (const auto& t : targets) bruteHits += b->hits(*t);
+        for (const auto& t : targets)
+            for (const auto& b : bullets) bruteHits += b->hits(*t);
+        auto t1 = std::chrono::steady_clock::now();
+        targetSweep.invalidate();
+        bulletSweep.invalidate();
+        for (const auto& b : bullets)
+            targetSweep.forEach(targets, *b, [&](const auto& t) {
+                sweepHits += b->hits(*t);
+            });
+        for (const auto& t : targets)
+            bulletSweep.forEach(bullets, *t, [&](const auto& b) {
+                sweepHits += b->hits(*t);
+            });
+        auto t2 = std::chrono::steady_clock::now();
+        bruteMicros += microsBetween(t0, t1);
+        sweepMicros += microsBetween(t1, t2);
+    }
+    pairs = perfStats.get(Stat::CollisionPairs) - pairs;
+
+    unsigned long long bruteTests =
+        2ULL * benchFrames * benchObjects * benchObjects;
+    out << stringFormat("broadphase: %d targets, %d bullets, %d frames\n",
+                        benchObjects, benchObjects, benchFrames);
+    out << stringFormat("  brute force %10.3f ms %12llu tests %8llu hits\n",
+                        bruteMicros / 1000.0, bruteTests, bruteHits);
+    out << stringFormat("  sweep       %10.3f ms %12llu tests %8llu hits\n",
+                        sweepMicros / 1000.0,
+                        static_cast<unsigned long long>(pairs), sweepHits);
+    if (bruteHits != sweepHits) out << "  MISMATCH: the sweep missed hits\n";
+}
+
+// the bullets of benchBullets are fired in front of the player and fly
+// away, so that they leave through the back plane
+static Point3D benchBulletPos() {
+    return Point3D(uniform(-0.5, 0.5), uniform(-0.5, 0.5),
+                   uniform(1, farObjectBackPlane));
+}
+
+static Point3D benchBulletVel() {
+    return Point3D(uniform(-0.125, 0.125), uniform(-0.125, 0.125),
+                   uniform(1, 4));
+}
+
+// keeps the world full of enemy bullets for benchFrames ticks and times
+// their updates, once as objects (the loop of game/sched.hh) and once in
+// the BulletSystem. both see the same bullets
+static void benchBullets(std::ostream& out) {
+    const size_t n = bulletsCapacity;
+    GameWorld w(std::make_shared<GameConfig>());
+    w.startNewStage();
+
+    seedRandomEngine(0);
+    BulletList objects;
+    uint64_t objectMicros = 0;
+    for (int frame = 0; frame < benchFrames; ++frame) {
+        while (objects.size() < n) {
+            Point3D p = benchBulletPos();
+            objects.push_back(makePooled<BenchBullet>(p, benchBulletVel()));
+        }
+        auto t0 = std::chrono::steady_clock::now();
+        size_t kept = 0;
+        for (size_t i = 0; i < objects.size(); ++i) {
+            auto& b = static_cast<BenchBullet&>(*objects[i]);
+            if (!b.tickAs<BenchBullet>(w, tickInterval)) continue;
+            if (kept != i) objects[kept] = std::move(objects[i]);
+            ++kept;
+        }
+        objects.erase(objects.begin() + kept, objects.end());
+        auto t1 = std::chrono::steady_clock::now();
+        objectMicros += microsBetween(t0, t1);
+    }
+
+    seedRandomEngine(0);
+    BulletSystem& bullets = w.getBulletSystem();
+    uint64_t systemMicros = 0;
+    for (int frame = 0; frame < benchFrames; ++frame) {
+        while (bullets.size() < n) {
+            Point3D p = benchBulletPos();
+            EnemyBullet::fire(bullets, p, benchBulletVel());
+        }
+        auto t0 = std::chrono::steady_clock::now();
+        bullets.update(w, tickInterval);
+        auto t1 = std::chrono::steady_clock::now();
+        systemMicros += microsBetween(t0, t1);
+    }
+
+    bool same = objects.size() == bullets.size();
+    for (size_t i = 0; same && i < bullets.size(); ++i)
+        same = objects[i]->pos == bullets[i].pos;
+
+    // how many bullets one tick could update in a millisecond
+    auto perMs = [](uint64_t micros) {
+        return micros ? 1000.0 * benchFrames * n / micros : 0.0;
+    };
+    out << stringFormat("bullets: %d bullets, %d frames\n",
+                        static_cast<int>(n), benchFrames);
+    out << stringFormat("  objects       %10.3f ms %10.0f bullets/ms\n",
+                        objectMicros / 1000.0, perMs(objectMicros));
+    out << stringFormat("  bullet system %10.3f ms %10.0f bullets/ms\n",
+                        systemMicros / 1000.0, perMs(systemMicros));
+    if (!same) out << "  MISMATCH: the bullets moved differently\n";
+}
+
+// how many vertices benchVertex projects for every model size
+static const size_t benchVertices = 1 << 22;
+
+// a perspective view like the one of Renderer3D with a model a little way in
+// front of it, so that some of the vertices are outside the frustum
+static Matrix3D benchVertexMatrix() {
+    const coord_t far = 8, k = far / (far - viewNear);
+    Matrix3D m(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, k, viewNear * k, 0, 0, 1, 0);
+    return m * Matrix3D::translate(Point3D(0.25, -0.125, 2)) *
+           Matrix3D3::rotate(Orient3D(0.5, 0.25, 0.125));
+}
+
+// true if a and b are within a few ulp of the largest of terms
+static bool closeEnough(coord_t a, coord_t b, const coord_t (&terms)[4]) {
+    coord_t t = std::max({std::abs(terms[0]), std::abs(terms[1]),
+                          std::abs(terms[2]), std::abs(terms[3])});
+    return std::abs(a - b) <= 8 * std::numeric_limits<coord_t>::epsilon() * t;
+}
+
+// projects random models of a few sizes, once through Matrix3D::project
+// into Vector3Ds with the outcodes computed afterwards (the path that
+// Renderer3D used before VertexLanes) and once with projectVertexLanes, and
+// checks that the results agree as promised in rend3d.hh
+static void benchVertex(std::ostream& out) {
+    const Matrix3D m = benchVertexMatrix();
+    out << stringFormat("vertex: %s kernel, %llu vertices per size\n",
+                        vertexKernelName(),
+                        static_cast<unsigned long long>(benchVertices));
+    for (size_t n : {16, 64, 512}) {
+        std::vector<Point3D> vertices;
+        for (size_t i = 0; i < n; ++i)
+            vertices.emplace_back(uniform(-2, 2), uniform(-2, 2),
+                                  uniform(-2, 2));
+        VertexLanes lanes(vertices);
+        std::vector<Vector3D> points(n, Vector3D(0, 0, 0, 0));
+        std::vector<uint8_t> outcodes(n);
+        ProjectedVertices projected;
+        size_t reps = benchVertices / n;
+
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < reps; ++r) {
+            for (size_t i = 0; i < n; ++i)
+                points[i] = m.project(Vector3D(vertices[i]));
+            for (size_t i = 0; i < n; ++i) {
+                const Vector3D& v = points[i];
+                outcodes[i] = clipOutcode(v.x, v.y, v.z, v.w);
+            }
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < reps; ++r)
+            projectVertexLanes(m, lanes, projected);
+        auto t2 = std::chrono::steady_clock::now();
+
+        size_t far = 0, outcodeDiffs = 0;
+        for (size_t i = 0; i < n; ++i) {
+            const Point3D& p = vertices[i];
+            const Vector3D& v = points[i];
+            coord_t a[4] = {v.x, v.y, v.z, v.w};
+            coord_t b[4] = {projected.x[i], projected.y[i], projected.z[i],
+                            projected.w[i]};
+            for (size_t row = 0; row < 4; ++row) {
+                const coord_t* r = m.m + 4 * row;
+                coord_t terms[4] = {p.x * r[0], p.y * r[1], p.z * r[2], r[3]};
+                if (!closeEnough(a[row], b[row], terms)) ++far;
+            }
+            outcodeDiffs += outcodes[i] != projected.outcode[i];
+        }
+
+        // nanoseconds per vertex
+        auto perVertex = [&](uint64_t micros) {
+            return 1000.0 * micros / (reps * n);
+        };
+        uint64_t projectMicros = microsBetween(t0, t1);
+        uint64_t lanesMicros = microsBetween(t1, t2);
+        out << stringFormat(
+            "  N=%-4d project %6.2f ns/vertex  lanes %6.2f ns/vertex %5.2fx\n",
+            static_cast<int>(n), perVertex(projectMicros),
+            perVertex(lanesMicros),
+            lanesMicros ? static_cast<double>(projectMicros) / lanesMicros
+                        : 0.0);
+        if (far)
+            out << stringFormat("  MISMATCH: %d coordinates out of tolerance\n",
+                                static_cast<int>(far));
+        if (outcodeDiffs)
+            out << stringFormat("  %d outcodes differ (points on a plane)\n",
+                                static_cast<int>(outcodeDiffs));
+    }
+}
+
+bool runBenchmark(const std::string& name, std::ostream& out) {
+    seedRandomEngine(0);
+    if (name == "broadphase") {
+        benchBroadphase(out);
+        return true;
+    }
+    if (name == "bullets") {
+        benchBullets(out);
+        return true;
+    }
+    if (name == "vertex") {
+        benchVertex(out);
+        return true;
+    }
+    return false;
+}
+
+}  // namespace hiemalia
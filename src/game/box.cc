@@ -26,33 +26,35 @@ Box::Box(const Point3D& pos, coord_t x, coord_t y, coord_t z)
     setCollisionRadius(scale.length());
 }
 
-void Box::absorbBullets(GameWorld& w, const BulletList& list) {
-    for (const auto& bptr : list) {
+template <typename List>
+void Box::absorbBullets(GameWorld& w, List& list) {
+    w.forEachNear(list, *this, [&](const auto& bptr) {
         if (bptr->hits(*this)) {
             bptr->backtrackCuboid(pos - scale, pos + scale);
             bptr->impact(w, false);
         }
-    }
+    });
 }
 
 void Box::absorbEnemies(GameWorld& w, const EnemyList& list) {
-    for (const auto& e : list) {
+    w.forEachNear(list, *this, [&](const auto& e) {
         if (e->canHitWalls() && e->hits(*this)) {
             Point3D dir = collidesCuboidPointDirection(e->pos, pos, scale);
             e->hitWall(w, dir.x, dir.y, dir.z);
         }
-    }
+    });
 }
 
 bool Box::update(GameWorld& w, float delta) {
     if (w.isPlayerAlive() && w.getPlayer().hits(*this)) {
         Point3D dir =
             collidesCuboidPointDirection(w.getPlayerPosition(), pos, scale);
-        w.getPlayer().wallContact(dir.x, dir.y, dir.z);
+        w.getPlayer().wallContact(w, dir.x, dir.y, dir.z);
     }
     absorbEnemies(w, w.getEnemies());
     absorbBullets(w, w.getPlayerBullets());
     absorbBullets(w, w.getEnemyBullets());
+    absorbBullets(w, w.getBulletSystem());
     return !isOffScreen();
 }
 
@@ -62,25 +64,27 @@ DestroyableBox::DestroyableBox(const Point3D& pos, coord_t x, coord_t y,
     useGameModel(GameModel::DestroyableBoxModel, true);
 }
 
-void DestroyableBox::absorbBullets(GameWorld& w, const BulletList& list) {
-    for (const auto& bptr : list) {
+template <typename List>
+void DestroyableBox::absorbBullets(GameWorld& w, List& list) {
+    w.forEachNear(list, *this, [&](const auto& bptr) {
         if (bptr->hits(*this)) {
             bptr->backtrackCuboid(pos - scale, pos + scale);
             damage(w, bptr->getDamage(), bptr->pos);
             bptr->impact(w, false);
         }
-    }
+    });
 }
 
 bool DestroyableBox::update(GameWorld& w, float delta) {
     if (w.isPlayerAlive() && w.getPlayer().hits(*this)) {
         Point3D dir =
             collidesCuboidPointDirection(w.getPlayerPosition(), pos, scale);
-        w.getPlayer().wallContact(dir.x, dir.y, dir.z);
+        w.getPlayer().wallContact(w, dir.x, dir.y, dir.z);
     }
     absorbEnemies(w, w.getEnemies());
     absorbBullets(w, w.getPlayerBullets());
     absorbBullets(w, w.getEnemyBullets());
+    absorbBullets(w, w.getBulletSystem());
     return alive_ && !isOffScreen();
 }
 
@@ -22,8 +22,10 @@ namespace hiemalia {
 BulletObject::BulletObject(const Point3D& pos) : GameObject(pos) {}
 
 bool BulletObject::update(GameWorld& w, float delta) {
-    bool alive = doBulletTick(w, delta);
-    if (!alive) return false;
+    return doBulletTick(w, delta) && afterTick(w, delta);
+}
+
+bool BulletObject::afterTick(GameWorld& w, float delta) {
     Orient3D frotvel = rotvel * delta;
     if (!checkInBounds(w)) return false;
     rot += frotvel;
@@ -47,24 +49,18 @@ Point3D BulletObject::lerp(coord_t p) const {
 }
 
 void BulletObject::backtrackCuboid(const Point3D& c1, const Point3D& c2) {
-    pos = collidesSweepSphereCuboidWhere(oldPos_, pos, getCollisionRadius(), c1,
-                                         c2);
-}
-
-void BulletObject::backtrackSphere(const Point3D& p, coord_t r2) {
-    pos = collidesSweepSphereSphereWhere(oldPos_, pos, getCollisionRadius(), p,
-                                         r2);
+    backtrack(collidesSweepSphereCuboidImpact(oldPos_, pos,
+                                              getCollisionRadius(), c1, c2));
 }
 
-void BulletObject::backtrackModel(const ModelCollision& mc,
-                                  const Matrix3D mat) {
-    pos = collidesSweepSphereModelWhere(oldPos_, pos, getCollisionRadius(), mc,
-                                        mat);
+SweepImpact BulletObject::impactOn(const GameObject& obj) const {
+    if (!nearby(obj)) return SweepImpact{};
+    return collidesSweepSphereObjectImpact(oldPos_, pos, getCollisionRadius(),
+                                           obj);
 }
 
-void BulletObject::backtrackObject(const GameObject& o) {
-    if (o.hasCollision())
-        backtrackModel(o.collision(), o.getObjectModelMatrix());
+void BulletObject::backtrack(const SweepImpact& impact) {
+    if (impact.hit) pos = impact.center;
 }
 
 bool BulletObject::checkInBounds(GameWorld& w) {
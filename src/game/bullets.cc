@@ -0,0 +1,271 @@
+/****************************************************************************/
+/*                                                                          */
+/*   HIEMALIA SOURCE CODE (C) 2021      SAMPO HIPPELAINEN (HISAHI).         */
+/*   SEE THE LICENSE FILE IN THE SOURCE ROOT DIRECTORY FOR LICENSE INFO.    */
+/*                                                                          */
+/****************************************************************************/
+// game/bullets.cc: implementation of BulletSystem
+
+#include "game/bullets.hh"
+
+#include <cmath>
+
+#include "audio.hh"
+#include "collide.hh"
+#include "game/obstacle.hh"
+#include "game/sched.hh"
+#include "game/world.hh"
+#include "hiemalia.hh"
+#include "stats.hh"
+
+namespace hiemalia {
+
+bool BulletRef::hits(const GameObject& obj) const {
+    coord_t r = s_.radius_[i_];
+    return obj.nearby(pos, r) &&
+           collidesSweepSphereObject(s_.oldPos_[i_], pos, r, obj);
+}
+
+SweepImpact BulletRef::impactOn(const GameObject& obj) const {
+    coord_t r = s_.radius_[i_];
+    if (!obj.nearby(pos, r)) return SweepImpact{};
+    return collidesSweepSphereObjectImpact(s_.oldPos_[i_], pos, r, obj);
+}
+
+void BulletRef::backtrack(const SweepImpact& impact) const {
+    if (impact.hit) s_.pos_[i_] = impact.center;
+}
+
+void BulletRef::backtrackCuboid(const Point3D& c1, const Point3D& c2) const {
+    backtrack(collidesSweepSphereCuboidImpact(s_.oldPos_[i_], pos,
+                                              s_.radius_[i_], c1, c2));
+}
+
+void BulletRef::impact(GameWorld& w, bool enemy) const {
+    if (!enemy) s_.explode(w, i_);
+    s_.flags_[i_] &= ~BulletSystem::Alive;
+}
+
+BulletSystem::BulletSystem() { resize(bulletsCapacity); }
+
+void BulletSystem::resize(size_t n) {
+    pos_.resize(n, Point3D::origin);
+    oldPos_.resize(n, Point3D::origin);
+    vel_.resize(n, Point3D::origin);
+    rot_.resize(n, Orient3D(0, 0, 0));
+    rotvel_.resize(n, Orient3D(0, 0, 0));
+    scale_.resize(n, 1);
+    radius_.resize(n, 0);
+    model_.resize(n, GameModel::BulletEnemy);
+    kind_.resize(n, BulletKind::Plain);
+    flags_.resize(n, 0);
+    target_.resize(n, Point3D::origin);
+    newVel_.resize(n, Point3D::origin);
+    hit_.resize(n);
+}
+
+void BulletSystem::fire(BulletKind kind, GameModel model, const Point3D& pos,
+                        const Point3D& vel, coord_t scale,
+                        const Point3D& target, const Point3D& newVel) {
+    if (count_ == pos_.size()) resize(count_ * 2);
+    size_t i = count_++;
+    pos_[i] = oldPos_[i] = pos;
+    vel_[i] = vel;
+    rot_[i] = Orient3D(0, 0, 0);
+    rotvel_[i] = Orient3D(1.8, 1.2, 0.6) * 16;
+    scale_[i] = scale;
+    radius_[i] = getGameModel(model).radius;
+    model_[i] = model;
+    kind_[i] = kind;
+    flags_[i] = Alive;
+    target_[i] = target;
+    newVel_[i] = newVel;
+}
+
+void BulletSystem::clear() { count_ = 0; }
+
+void BulletSystem::move(const Point3D& d) {
+    for (size_t i = 0; i < count_; ++i) {
+        oldPos_[i] = pos_[i];
+        pos_[i] += d;
+    }
+}
+
+void BulletSystem::update(GameWorld& w, float delta) {
+    // the kernels that run before the move
+    for (size_t i = 0; i < count_; ++i) {
+        switch (kind_[i]) {
+            case BulletKind::Homing:
+                steer(w, i, delta);
+                break;
+            case BulletKind::Blocker:
+                if (place(w, i)) flags_[i] = Gone;
+                break;
+            default:
+                break;
+        }
+    }
+    perfStats.peak(Stat::PeakBullets, count_);
+    integrate(delta);
+    collidePlayer(w);
+    resolve(w, delta);
+}
+
+void BulletSystem::integrate(float delta) {
+    for (size_t i = 0; i < count_; ++i) {
+        oldPos_[i] = pos_[i];
+        pos_[i] += delta * vel_[i];
+        rot_[i] += rotvel_[i];
+    }
+}
+
+void BulletSystem::collidePlayer(GameWorld& w) {
+    if (!w.isPlayerAlive()) {
+        for (size_t i = 0; i < count_; ++i) hit_[i].hit = false;
+        return;
+    }
+    const PlayerObject& p = w.getPlayer();
+    for (size_t i = 0; i < count_; ++i)
+        hit_[i] = p.nearby(pos_[i], radius_[i])
+                      ? collidesSweepSphereObjectImpact(oldPos_[i], pos_[i],
+                                                        radius_[i], p)
+                      : SweepImpact{};
+}
+
+static bool sameAngles(const Orient3D& a, const Orient3D& b) {
+    return a.yaw == b.yaw && a.pitch == b.pitch && a.roll == b.roll;
+}
+
+// the rest has effects on the world, so it goes in the order the bullets
+// were fired in
+void BulletSystem::resolve(GameWorld& w, float delta) {
+    // Orient3D * wraps every angle, which is slow. the bullets usually share
+    // their rotvel, so the turn is only computed again when it changes
+    Orient3D turnOf = rotvel_[0], turn = turnOf * delta;
+    size_t out = 0;
+    for (size_t i = 0; i < count_; ++i) {
+        if (flags_[i] & Gone) continue;
+        if (hit_[i].hit) {
+            PlayerObject& p = w.getPlayer();
+            if (p.playerInControl()) p.damage(w, 1.0f, hit_[i].contact);
+            explode(w, i);
+            flags_[i] &= ~Alive;
+        }
+        if (kind_[i] == BulletKind::Slide) slide(i);
+
+        const Point3D& pos = pos_[i];
+        const MoveRegion& r = w.getMoveRegionForZ(pos.z);
+        if (pos.y < r.y0 || pos.y > r.y1 || pos.x < r.x0 || pos.x > r.x1) {
+            explode(w, i);
+            continue;
+        }
+        if (!sameAngles(rotvel_[i], turnOf))
+            turnOf = rotvel_[i], turn = turnOf * delta;
+        rot_[i] += turn;
+        if (!(flags_[i] & Alive) || pos.z < -radius_[i] ||
+            (vel_[i].z > 0 && pos.z >= farObjectBackPlane + radius_[i]))
+            continue;
+
+        if (out != i) {
+            pos_[out] = pos_[i];
+            oldPos_[out] = oldPos_[i];
+            vel_[out] = vel_[i];
+            rot_[out] = rot_[i];
+            rotvel_[out] = rotvel_[i];
+            scale_[out] = scale_[i];
+            radius_[out] = radius_[i];
+            model_[out] = model_[i];
+            kind_[out] = kind_[i];
+            flags_[out] = flags_[i];
+            target_[out] = target_[i];
+            newVel_[out] = newVel_[i];
+        }
+        ++out;
+    }
+    count_ = out;
+}
+
+void BulletSystem::explode(GameWorld& w, size_t i) {
+    coord_t s = scale_[i];
+    w.getParticles().explode(pos_[i], *getGameModel(model_[i]).model, rot_[i],
+                             Point3D(s, s, s), 0.0, 0.0, 0.0, 8.0f);
+}
+
+void BulletSystem::render(SplinterBuffer& sbuf, Renderer3D& r3d,
+                          ObjectDrawer& drawer, coord_t lateZ) const {
+    for (size_t i = 0; i < count_; ++i) {
+        if (pos_[i].z >= lateZ) continue;
+        coord_t s = scale_[i];
+        drawer.drawInstance(sbuf, r3d, *getGameModel(model_[i]).model,
+                            ModelTransform{pos_[i], rot_[i], Point3D(s, s, s)});
+    }
+}
+
+static Point3D bulletAimAt(const Point3D& me, coord_t speed, const Point3D& p0,
+                           const Point3D& x) {
+    if (x.isZero()) return (p0 - me).normalize() * speed;
+    Point3D ax = x * (1 + ((p0 - me).length() / (speed * 32)));
+    Point3D p = p0 + ax;
+    Point3D d = p - me;
+    Point3D y = d - ax * (ax.dot(d) / ax.dot(ax));
+    Point3D pointOfContact = p0 + ax * (y.length() / speed);
+    return (pointOfContact - me).normalize() * speed;
+}
+
+static Point3D aimAtPlayer(GameWorld& w, const Point3D& me, float speed,
+                           float lead) {
+    speed *= w.difficulty().getBulletSpeedMultiplier();
+    lead *= w.difficulty().getBulletLeadMultiplier();
+    Point3D nonLead = bulletAimAt(me, speed, w.getPlayerPosition(),
+                                  Point3D(0, 0, w.getMoveSpeed()));
+    Point3D yesLead =
+        lead == 0
+            ? nonLead
+            : bulletAimAt(
+                  me, speed, w.getPlayerPosition(),
+                  w.getPlayer().vel * sqrt(w.getPlayer().vel.length()) * 0.125 +
+                      Point3D(0, 0, w.getMoveSpeed() + w.getMoveSpeedDelta()));
+    return Point3D::lerp(nonLead, lead, yesLead);
+}
+
+// the player does not move during the update, so all bullets can steer
+// before any of them hits
+void BulletSystem::steer(GameWorld& w, size_t i, float delta) {
+    if (!w.isPlayerAlive()) return;
+    Point3D ppos = w.getPlayerPosition();
+    Point3D& pos = pos_[i];
+    Point3D& vel = vel_[i];
+    if (pos.z > ppos.z) {
+        Orient3D cur = Orient3D::toPolar(vel);
+        Orient3D unr = Orient3D::toPolar(
+            aimAtPlayer(w, pos, static_cast<float>(vel.length()), 1.0f));
+        Orient3D target = cur.tendTo(unr, delta * 2.5);
+        vel = target.direction(vel.length());
+        vel.z = -abs(vel.z);
+    }
+}
+
+bool BulletSystem::place(GameWorld& w, size_t i) {
+    const Point3D& pos = pos_[i];
+    if (pos.z > target_[i].z) return false;
+    sendMessage(AudioMessage::playSound(SoundEffect::BlockerPlace,
+                                        pos - w.getPlayerPosition()));
+    w.spawn<DestroyableObstacle>(pos, Orient3D(0, 0, 0),
+                                 GameModel::ObstacleBlocker, 2.0f);
+    return true;
+}
+
+void BulletSystem::slide(size_t i) {
+    const Point3D& vel = vel_[i];
+    Point3D& pos = pos_[i];
+    const Point3D& target = target_[i];
+    if (!(flags_[i] & Crossed) && ((vel.z > 0 && pos.z >= target.z) ||
+                                   (vel.z < 0 && pos.z <= target.z))) {
+        flags_[i] |= Crossed;
+        pos.x = target.x;
+        pos.y = target.y;
+        vel_[i] = newVel_[i];
+    }
+}
+
+}  // namespace hiemalia
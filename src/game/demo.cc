@@ -36,6 +36,8 @@ DemoFile DemoFile::loadDemo(const std::string& file) {
     std::vector<DemoCommand> commands;
 
     for (std::string line; std::getline(in, line);) {
+        // the bundled demos have CRLF line endings
+        if (!line.empty() && line.back() == '\r') line.pop_back();
         if (line.empty() || line[0] == '#') continue;
         auto command = line.substr(0, line.find(' '));
         std::string value;
@@ -95,20 +97,28 @@ bool DemoFile::runDemo(float dt) {
 void DemoFile::reset() {
     commandIndex_ = 0;
     t_ = 0;
+    input_ = ControlState{};
 }
 
-static auto demoFileNames = hiemalia::makeArray<std::string>({"demo.dem"});
+static std::vector<std::string> demoFileNames{"demo.dem"};
 static std::vector<std::shared_ptr<DemoFile>> loadedDemos{demoFileNames.size(),
                                                           nullptr};
 static size_t nextDemo = 0;
 
 std::shared_ptr<DemoFile> getNextDemo() {
     if (loadedDemos.empty()) return nullptr;
-    if (!loadedDemos[nextDemo])
-        loadedDemos[nextDemo] = std::make_shared<DemoFile>(
+    std::shared_ptr<DemoFile>& demo = loadedDemos[nextDemo];
+    if (!demo)
+        demo = std::make_shared<DemoFile>(
             DemoFile::loadDemo(demoFileNames[nextDemo]));
     nextDemo = (nextDemo + 1) % loadedDemos.size();
-    loadedDemos[nextDemo].reset();
-    return loadedDemos[nextDemo];
+    demo->reset();
+    return demo;
+}
+
+void useOnlyDemo(const std::string& file) {
+    demoFileNames = {file};
+    loadedDemos = {nullptr};
+    nextDemo = 0;
 }
 }  // namespace hiemalia
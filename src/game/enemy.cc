@@ -23,20 +23,21 @@ EnemyObject::EnemyObject(const Point3D& pos, float health)
     : GameObject(pos), ObjectDamageable(health) {}
 
 bool EnemyObject::update(GameWorld& w, float delta) {
-    if (sponge_ > 0) {
-        for (const auto& bptr : w.getPlayerBullets()) {
-            if (bptr->hits(*this)) {
-                bptr->impact(w, true);
-            }
-        }
-        sponge_ -= delta;
-        return sponge_ > 0;
-    }
-
+    if (sponge_ > 0) return spongeTick(w, delta);
     if (!alive_) return false;
     return doEnemyTick(w, delta);
 }
 
+bool EnemyObject::spongeTick(GameWorld& w, float delta) {
+    w.forEachNear(w.getPlayerBullets(), *this, [&](const auto& bptr) {
+        if (bptr->hits(*this)) {
+            bptr->impact(w, true);
+        }
+    });
+    sponge_ -= delta;
+    return sponge_ > 0;
+}
+
 void EnemyObject::kill(GameWorld& w) { alive_ = false; }
 
 bool EnemyObject::hitBullet(GameWorld& w, float dmg, const Point3D& c) {
@@ -92,7 +93,7 @@ void EnemyObject::killPlayerOnContact(GameWorld& w) {
     if (w.isPlayerAlive()) {
         PlayerObject& p = w.getPlayer();
         if (hits(p)) {
-            p.enemyContact();
+            p.enemyContact(w);
         }
     }
 }
@@ -9,7 +9,6 @@
 #include "game/enemy/blocker.hh"
 
 #include "audio.hh"
-#include "game/obstacle.hh"
 #include "game/world.hh"
 #include "hiemalia.hh"
 #include "math.hh"
@@ -56,20 +55,11 @@ bool EnemyBlocker::onEnemyDeath(GameWorld& w, bool killedByPlayer) {
     return true;
 }
 
-EnemyBulletBlocker::EnemyBulletBlocker(const Point3D& pos, const Point3D& v)
-    : EnemyBullet(pos, v) {
-    useGameModel(GameModel::BulletEnemyBlocker);
-}
-
-bool EnemyBulletBlocker::doBulletTick(GameWorld& w, float delta) {
-    if (pos.z <= dist) {
-        sendMessage(AudioMessage::playSound(SoundEffect::BlockerPlace,
-                                            pos - w.getPlayerPosition()));
-        w.spawn<DestroyableObstacle>(pos, Orient3D(0, 0, 0),
-                                     GameModel::ObstacleBlocker, 2.0f);
-        return false;
-    }
-    return EnemyBullet::doBulletTick(w, delta);
+// placed as an obstacle by the Blocker kernel of BulletSystem
+void EnemyBulletBlocker::fire(BulletSystem& s, const Point3D& pos,
+                              const Point3D& v) {
+    s.fire(BulletKind::Blocker, GameModel::BulletEnemyBlocker, pos, v, 1,
+           Point3D(0, 0, dist));
 }
 
 }  // namespace hiemalia
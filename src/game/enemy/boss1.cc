@@ -33,9 +33,9 @@ bool EnemyBoss1::doEnemyTick(GameWorld& w, float delta) {
     if (dp.length() > v) dp = dp.normalize() * v;
     pos += dp;
     if (pos.z < tz)
-        pos.z = std::min(tz, pos.z + delta * 0.75);
+        pos.z = std::min<coord_t>(tz, pos.z + delta * 0.75);
     else if (pos.z > tz)
-        pos.z = std::max(tz, pos.z - delta * 0.75);
+        pos.z = std::max<coord_t>(tz, pos.z - delta * 0.75);
     fireTime_ +=
         delta * (wall_ ? 3.6f : 0.6f) * w.difficulty().getFireRateMultiplier();
     killPlayerOnContact(w);
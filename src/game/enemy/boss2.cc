@@ -39,9 +39,9 @@ bool EnemyBoss2::doEnemyTick(GameWorld& w, float delta) {
     if (dp.length() > v) dp = dp.normalize() * v;
     pos += dp;
     if (pos.z < tz)
-        pos.z = std::min(tz, pos.z + delta * 0.75);
+        pos.z = std::min<coord_t>(tz, pos.z + delta * 0.75);
     else if (pos.z > tz)
-        pos.z = std::max(tz, pos.z - delta * 0.75);
+        pos.z = std::max<coord_t>(tz, pos.z - delta * 0.75);
     killPlayerOnContact(w);
     if (w.isPlayerAlive() &&
         pos.z - w.getPlayerPosition().z > getCollisionRadius() * 0.5) {
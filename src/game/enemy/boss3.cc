@@ -52,9 +52,9 @@ bool EnemyBoss3::doEnemyTick(GameWorld& w, float delta) {
     Point3D dp = np - op;
     if (dp.length() > v) dp = dp.normalize() * v;
     if (pos.z < tz)
-        pos.z = std::min(tz, pos.z + delta * 0.75);
+        pos.z = std::min<coord_t>(tz, pos.z + delta * 0.75);
     else if (pos.z > tz)
-        pos.z = std::max(tz, pos.z - delta * 0.75);
+        pos.z = std::max<coord_t>(tz, pos.z - delta * 0.75);
     killPlayerOnContact(w);
     if (eye_ > 0) {
         pos += dp;
@@ -33,8 +33,10 @@ void EnemyBoss5::onSpawn(GameWorld& w) {
 }
 
 void EnemyBoss5::render(SplinterBuffer& sbuf, Renderer3D& r3d) {
-    EnemyObject::render(sbuf, r3d);
-    if (phase_ == 0) r3d.renderModel(sbuf, pos, rot, scale, *bModel_.model);
+    const Model* m = hasModel() ? &model() : nullptr;
+    ModelPart parts[] = {{m}, {bModel_.model.get()}};
+    r3d.renderModels(sbuf, getObjectModelMatrix(), scale, parts,
+                     phase_ == 0 ? 2 : 1);
 }
 
 bool EnemyBoss5::doEnemyTick(GameWorld& w, float delta) {
@@ -66,9 +68,9 @@ bool EnemyBoss5::doEnemyTick(GameWorld& w, float delta) {
     }
     coord_t tz = w.getPlayerPosition().z + 2.75;
     if (pos.z < tz)
-        pos.z = std::min(tz, pos.z + delta * 0.75);
+        pos.z = std::min<coord_t>(tz, pos.z + delta * 0.75);
     else if (pos.z > tz)
-        pos.z = std::max(tz, pos.z - delta * 0.75);
+        pos.z = std::max<coord_t>(tz, pos.z - delta * 0.75);
     killPlayerOnContact(w);
     if (invul_ > 0 || !w.isPlayerAlive()) return true;
     switch (phase_) {
@@ -34,8 +34,10 @@ bool EnemyBoss6::hitEnemy(GameWorld& w, float dmg,
 void EnemyBoss6::onSpawn(GameWorld& w) { speed_ = w.pushBoss({59}, 0.5); }
 
 void EnemyBoss6::render(SplinterBuffer& sbuf, Renderer3D& r3d) {
-    EnemyObject::render(sbuf, r3d);
-    if (phase_ == 0) r3d.renderModel(sbuf, pos, rot, scale, *bModel_.model);
+    const Model* m = hasModel() ? &model() : nullptr;
+    ModelPart parts[] = {{m}, {bModel_.model.get()}};
+    r3d.renderModels(sbuf, getObjectModelMatrix(), scale, parts,
+                     phase_ == 0 ? 2 : 1);
 }
 
 bool EnemyBoss6::doEnemyTick(GameWorld& w, float delta) {
@@ -46,7 +48,7 @@ bool EnemyBoss6::doEnemyTick(GameWorld& w, float delta) {
     if (pos.z < tz)
         pos.z = std::min(tz, pos.z + delta * (pos.z <= 2 ? 3 - pos.z : 1));
     else if (pos.z > tz)
-        pos.z = std::max(tz, pos.z - delta * 0.75);
+        pos.z = std::max<coord_t>(tz, pos.z - delta * 0.75);
     if (!w.isPlayerAlive()) return true;
     switch (phase_) {
         case 0: {
@@ -35,9 +35,10 @@ bool EnemyBoss7::hitEnemy(GameWorld& w, float dmg,
 void EnemyBoss7::onSpawn(GameWorld& w) { speed_ = w.pushBoss({59}, 0.333); }
 
 void EnemyBoss7::render(SplinterBuffer& sbuf, Renderer3D& r3d) {
-    EnemyObject::render(sbuf, r3d);
-    if (phase_ < 2) r3d.renderModel(sbuf, pos, rot, scale, *bModel_.model);
-    if (phase_ < 1) r3d.renderModel(sbuf, pos, rot, scale, *cModel_.model);
+    const Model* m = hasModel() ? &model() : nullptr;
+    ModelPart parts[] = {{m}, {bModel_.model.get()}, {cModel_.model.get()}};
+    size_t n = phase_ < 1 ? 3 : phase_ < 2 ? 2 : 1;
+    r3d.renderModels(sbuf, getObjectModelMatrix(), scale, parts, n);
 }
 
 static float getFlipInterval() {
@@ -54,7 +55,7 @@ bool EnemyBoss7::doEnemyTick(GameWorld& w, float delta) {
     if (pos.z < tz)
         pos.z = std::min(tz, pos.z + delta * (pos.z <= 1.5 ? 2.0f : 1.0f));
     else if (pos.z > tz)
-        pos.z = std::max(tz, pos.z - delta * 0.75);
+        pos.z = std::max<coord_t>(tz, pos.z - delta * 0.75);
     if (!w.isPlayerAlive()) return true;
     switch (phase_) {
         case 0: {
@@ -24,7 +24,7 @@ EnemyChevron::EnemyChevron(const Point3D& pos) : EnemyObject(pos, 10.0f) {
 
 bool EnemyChevron::doEnemyTick(GameWorld& w, float delta) {
     if (sawPlayer_) {
-        coord_t m = std::max(w.getMoveSpeed(), 1.0);
+        coord_t m = std::max<coord_t>(w.getMoveSpeed(), 1.0);
         if (w.isPlayerAlive()) {
             Point3D d = w.getPlayerPosition() - pos;
             d.x *= m * 1.5;
@@ -39,11 +39,11 @@ bool EnemyChevron::doEnemyTick(GameWorld& w, float delta) {
         trot.roll = vel.x;
         vel *= std::pow(2, delta * m);
         if (rot.roll < trot.roll) {
-            rot.roll = std::min(trot.roll, rot.roll + 0.5 * delta);
+            rot.roll = std::min<coord_t>(trot.roll, rot.roll + 0.5 * delta);
         } else if (rot.roll > trot.roll) {
-            rot.roll = std::max(trot.roll, rot.roll - 0.5 * delta);
+            rot.roll = std::max<coord_t>(trot.roll, rot.roll - 0.5 * delta);
         }
-        mz_ = std::min(mz_, vel.z * (0.75 / m));
+        mz_ = std::min<coord_t>(mz_, vel.z * (0.75 / m));
     } else if (w.isPlayerAlive() &&
                (pos - w.getPlayerPosition()).z < stageSpawnDistance - 0.5) {
         sawPlayer_ = true;
@@ -52,8 +52,8 @@ bool EnemyChevron::doEnemyTick(GameWorld& w, float delta) {
         doMove(delta, {0, 0, -1.0 / 128});
     }
     killPlayerOnContact(w);
-    coord_t xr = lerp(0.2 * 0.375, cos(rot.roll), 1 * 0.375);
-    coord_t yr = lerp(0.2 * 0.375, sin(rot.roll), 1 * 0.375);
+    coord_t xr = lerp<coord_t>(0.2 * 0.375, cos(rot.roll), 1 * 0.375);
+    coord_t yr = lerp<coord_t>(0.2 * 0.375, sin(rot.roll), 1 * 0.375);
     explodeIfOutOfBounds(w, xr, xr, yr, yr);
     return !isOffScreen();
 }
@@ -63,10 +63,10 @@ bool EnemySpider::doEnemyTick(GameWorld& w, float delta) {
         walk_ = walk_ && !pounce_;
 
         if (walk_) {
-            walkMul_ = std::min(coord_t(1), walkMul_ + delta * 4.0);
+            walkMul_ = std::min<coord_t>(1, walkMul_ + delta * 4.0);
             walkCycle_ = wrapAngle(walkCycle_ + walkMul_ * delta * 15);
         } else {
-            walkMul_ = std::max(coord_t(0), walkMul_ - delta * 4.0);
+            walkMul_ = std::max<coord_t>(0, walkMul_ - delta * 4.0);
         }
         if (angleDiff != 0) {
             walkMul_ = std::max(coord_t(0), walkMul_ - angleDiff);
@@ -55,7 +55,8 @@ void EnemyTurret::aim(GameWorld& w, float delta) {
 
 void EnemyTurret::render(SplinterBuffer& sbuf, Renderer3D& r3d) {
     EnemyObject::render(sbuf, r3d);
-    r3d.renderModel(sbuf, pos, baseRot_, scale, *baseModel_.model);
+    r3d.renderModel(sbuf, baseMatrix_.get(pos, baseRot_, scale), scale,
+                    *baseModel_.model);
 }
 
 void EnemyTurret::onSpawn(GameWorld& w) {
@@ -89,8 +89,10 @@ bool EnemyWalker::doEnemyTick(GameWorld& w, float delta) {
 
 void EnemyWalker::render(SplinterBuffer& sbuf, Renderer3D& r3d) {
     EnemyObject::render(sbuf, r3d);
-    r3d.renderModel(sbuf, pos, exCol_[0].rot, exCol_[0].scale, *leftLeg_.model);
-    r3d.renderModel(sbuf, pos, exCol_[1].rot, exCol_[1].scale,
+    // the legs are drawn with the same transforms as their collision
+    r3d.renderModel(sbuf, exCol_[0].getModelMatrix(pos), exCol_[0].scale,
+                    *leftLeg_.model);
+    r3d.renderModel(sbuf, exCol_[1].getModelMatrix(pos), exCol_[1].scale,
                     *rightLeg_.model);
 }
 
@@ -51,9 +51,9 @@ bool EnemyWasp::doEnemyTick(GameWorld& w, float delta) {
     }
     coord_t p;
     if (anim_ >= 0.5)
-        p = lerp(0.5, anim_ * 2 - 1, -0.5);
+        p = lerp<coord_t>(0.5, anim_ * 2 - 1, -0.5);
     else
-        p = lerp(-0.5, anim_ * 2, 0.5);
+        p = lerp<coord_t>(-0.5, anim_ * 2, 0.5);
     exCol_[0].pos = pos + wingOffset;
     exCol_[0].rot = rot + Orient3D(0, 0, -p);
     exCol_[1].pos = pos + wingOffset;
@@ -79,7 +79,8 @@ void EnemyWheeledTurret::moveAround(GameWorld& w, float delta) {
 
 void EnemyWheeledTurret::render(SplinterBuffer& sbuf, Renderer3D& r3d) {
     EnemyObject::render(sbuf, r3d);
-    r3d.renderModel(sbuf, pos, baseRot_, scale, *baseModel_.model);
+    r3d.renderModel(sbuf, baseMatrix_.get(pos, baseRot_, scale), scale,
+                    *baseModel_.model);
 }
 
 void EnemyWheeledTurret::onSpawn(GameWorld& w) {
@@ -4,18 +4,18 @@
 /*   SEE THE LICENSE FILE IN THE SOURCE ROOT DIRECTORY FOR LICENSE INFO.    */
 /*                                                                          */
 /****************************************************************************/
-// game/explode.cc: implementation of Explosion
+// game/explode.cc: implementation of ParticleSystem
 
 #include "game/explode.hh"
 
 #include <cmath>
 
-#include "assets.hh"
-#include "collide.hh"
-#include "game/world.hh"
+#include "game/object.hh"
+#include "logger.hh"
 #include "model.hh"
 #include "random.hh"
 #include "rend3d.hh"
+#include "stats.hh"
 
 namespace hiemalia {
 static std::uniform_real_distribution<coord_t> rd_negative(-0.5, 0.0);
@@ -55,96 +55,255 @@ static Point3D getRandomVelocity(coord_t xm, coord_t ym, coord_t zm) {
     return Point3D(x, y, z);
 }
 
-static Orient3D getRandomRotation(coord_t xm, coord_t ym, coord_t zm) {
-    return Orient3D{random(rd_rotation), random(rd_rotation),
-                    random(rd_rotation)};
+static Point3D getRandomSpin(coord_t xm, coord_t ym, coord_t zm) {
+    return Point3D{random(rd_rotation), random(rd_rotation),
+                   random(rd_rotation)};
 }
 
-void Explosion::cutShards(coord_t xm, coord_t ym, coord_t zm) {
-    float explspeedinv = 1.0f / explspeed_;
-    for (size_t i = 0, e = shards_p0_.size(); i < e; ++i) {
-        if ((shards_p1_[i] - shards_p0_[i]).lengthSquared() > 0.015625 &&
+ParticleSystem::ParticleSystem()
+    : emitters_(explosionsMax),
+      free_(),
+      live_(),
+      p0_(explosionsMax * maxShards, Point3D::origin),
+      p1_(explosionsMax * maxShards, Point3D::origin),
+      pos_(explosionsMax * maxShards, Point3D::origin),
+      dpos_(explosionsMax * maxShards, Point3D::origin),
+      rot_(explosionsMax * maxShards, Quaternion::identity()),
+      spin_(explosionsMax * maxShards, Point3D::origin),
+      step_(explosionsMax * maxShards, Quaternion::identity()) {
+    free_.reserve(explosionsMax);
+    live_.reserve(explosionsMax);
+    for (size_t i = explosionsMax; i > 0; --i)
+        free_.push_back(static_cast<uint16_t>(i - 1));
+    perfStats.peak(Stat::ParticleBytes,
+                   explosionsMax * (sizeof(Emitter) +
+                                    maxShards * (5 * sizeof(Point3D) +
+                                                 2 * sizeof(Quaternion))));
+}
+
+ParticleSystem::Emitter* ParticleSystem::get(ParticleHandle h) {
+    if (!h || h.index >= explosionsMax) return nullptr;
+    Emitter& e = emitters_[h.index];
+    return e.generation == h.generation ? &e : nullptr;
+}
+
+const ParticleSystem::Emitter* ParticleSystem::get(ParticleHandle h) const {
+    if (!h || h.index >= explosionsMax) return nullptr;
+    const Emitter& e = emitters_[h.index];
+    return e.generation == h.generation ? &e : nullptr;
+}
+
+uint16_t ParticleSystem::allocate() {
+    if (free_.empty()) {
+        // reuse the attached explosion that has faded the most
+        size_t victim = live_.size();
+        for (size_t i = 0, n = live_.size(); i < n; ++i) {
+            const Emitter& e = emitters_[live_[i]];
+            if (!e.detached && (victim == live_.size() ||
+                                e.alpha < emitters_[live_[victim]].alpha))
+                victim = i;
+        }
+        dynamic_assert(victim < live_.size(), "explosion pool exhausted");
+        LOG_DEBUG("explosion pool full; reusing a slot");
+        release(victim);
+    }
+    uint16_t i = free_.back();
+    free_.pop_back();
+    live_.push_back(i);
+    Emitter& e = emitters_[i];
+    // zero is never a valid generation
+    if (!++e.generation) ++e.generation;
+    return i;
+}
+
+void ParticleSystem::release(size_t liveIndex) {
+    uint16_t i = live_[liveIndex];
+    shards_ -= emitters_[i].count;
+    emitters_[i].count = 0;
+    ++emitters_[i].generation;
+    live_[liveIndex] = live_.back();
+    live_.pop_back();
+    free_.push_back(i);
+}
+
+void ParticleSystem::cutShards(size_t e, const Quaternion& rot, coord_t xm,
+                               coord_t ym, coord_t zm) {
+    Emitter& em = emitters_[e];
+    size_t base = e * maxShards;
+    float explspeedinv = 1.0f / em.explspeed;
+    for (size_t i = base, end = base + em.count; i < end; ++i) {
+        if (em.count < maxShards &&
+            (p1_[i] - p0_[i]).lengthSquared() > 0.015625 &&
             random(rd_split) != 0) {
-            shards_p0_[i] *= 0.5;
-            shards_p1_[i] *= 0.5;
-            shards_p0_.push_back(shards_p0_[i]);
-            shards_p1_.push_back(shards_p1_[i]);
-            shards_pos_.push_back(pos + shards_p0_[i]);
-            shards_dpos_.push_back(getRandomVelocity(xm, ym, zm) *
-                                   explspeedinv);
-            shards_rot_.push_back(rot);
-            shards_drot_.push_back(getRandomRotation(xm, ym, zm));
-            shards_pos_[i] += shards_p1_[i];
+            size_t j = base + em.count++;
+            p0_[i] *= 0.5;
+            p1_[i] *= 0.5;
+            p0_[j] = p0_[i];
+            p1_[j] = p1_[i];
+            pos_[j] = em.pos + p0_[i];
+            dpos_[j] = getRandomVelocity(xm, ym, zm) * explspeedinv;
+            rot_[j] = rot;
+            spin_[j] = getRandomSpin(xm, ym, zm);
+            pos_[i] += p1_[i];
         }
     }
 }
 
-Explosion::Explosion(const Point3D& pos, const GameObject& o, coord_t xm,
-                     coord_t ym, coord_t zm, float explspeed)
-    : Explosion(pos, o, o.model(), xm, ym, zm, explspeed) {}
+ParticleHandle ParticleSystem::explode(const Point3D& pos, const GameObject& o,
+                                       coord_t xm, coord_t ym, coord_t zm,
+                                       float explspeed, bool detached) {
+    return explode(pos, o.model(), o.rot, o.scale, xm, ym, zm, explspeed,
+                   detached);
+}
+
+ParticleHandle ParticleSystem::explode(const Point3D& pos, const Model& model,
+                                       const Orient3D& orient,
+                                       const Point3D& scale, coord_t xm,
+                                       coord_t ym, coord_t zm, float explspeed,
+                                       bool detached) {
+    uint16_t e = allocate();
+    Emitter& em = emitters_[e];
+    em.pos = pos;
+    em.color = Color{255, 128, 0, 255};
+    em.alpha = 1;
+    em.explspeed = explspeed;
+    em.detached = detached;
+    em.stepDelta = 0;
+    em.count = 0;
 
-Explosion::Explosion(const Point3D& p, const GameObject& o, const Model& model,
-                     coord_t xm, coord_t ym, coord_t zm, float explspeed)
-    : GameObject(p), explspeed_(explspeed) {
+    size_t base = e * maxShards;
     float explspeedinv = 1.0f / explspeed;
-    tempModel_.vertices.emplace_back(0, 0, 0);
-    tempModel_.vertices.emplace_back(0, 0, 0);
-    tempModel_.shapes.push_back(ModelFragment(Color{255, 128, 0, 255}, 0, {1}));
-    rot = o.rot;
+    Quaternion rot = Quaternion::fromOrient3D(orient);
     for (const ModelFragment& f : model.shapes) {
-        const Point3D* prev = &(model.vertices[f.start]);
+        Point3D prev = model.vertices[f.start];
         for (size_t pi : f.points) {
-            Point3D p0 = prev->hadamard(o.scale);
-            Point3D p1 = model.vertices[pi].hadamard(o.scale);
+            if (em.count >= maxShards) break;
+            Point3D p0 = prev.hadamard(scale);
+            Point3D p1 = model.vertices[pi].hadamard(scale);
             Point3D c = Point3D::average(p0, p1);
-            shards_p0_.push_back(p0 - c);
-            shards_p1_.push_back(p1 - c);
-            shards_pos_.push_back(pos + c);
-            shards_dpos_.push_back(getRandomVelocity(xm, ym, zm) *
-                                   explspeedinv);
-            shards_rot_.push_back(rot);
-            shards_drot_.push_back(getRandomRotation(xm, ym, zm));
-            prev = &p1;
+            size_t j = base + em.count++;
+            p0_[j] = p0 - c;
+            p1_[j] = p1 - c;
+            pos_[j] = pos + c;
+            dpos_[j] = getRandomVelocity(xm, ym, zm) * explspeedinv;
+            rot_[j] = rot;
+            spin_[j] = getRandomSpin(xm, ym, zm);
+            prev = p1;
         }
     }
 
-    for (int i = 0; i < 3 && shards_p0_.size() <= maxShards / 2; ++i)
-        cutShards(xm, ym, zm);
+    for (int i = 0; i < 3 && em.count <= maxShards / 2; ++i)
+        cutShards(e, rot, xm, ym, zm);
+
+    shards_ += em.count;
+    perfStats.peak(Stat::ParticleEmitters, live_.size());
+    perfStats.peak(Stat::ParticleShards, shards_);
+    return ParticleHandle{e, em.generation};
 }
 
-bool Explosion::update(GameWorld& w, float delta) {
-    alpha_ -= delta * 0.4f * explspeed_;
-    // coord_t mul = std::pow(0.5, 1.0 / delta);
-    for (size_t i = 0, e = shards_pos_.size(); i < e; ++i) {
-        shards_pos_[i] += shards_dpos_[i] * delta;
-        shards_rot_[i] += shards_drot_[i] * delta;
-        // shards_drot_[i] *= mul;
+void ParticleSystem::adjustSpeed(ParticleHandle h, coord_t s) {
+    Emitter* em = get(h);
+    if (!em) return;
+    size_t base = h.index * maxShards;
+    for (size_t i = base, end = base + em->count; i < end; ++i) {
+        dpos_[i] *= s;
+        spin_[i] *= s;
     }
-    tempModel_.shapes[0].color.a =
-        static_cast<uint8_t>(255 * std::sqrt(alpha_));
-    return alpha_ > 0;
+    em->stepDelta = 0;
+}
+
+bool ParticleSystem::alive(ParticleHandle h) const noexcept {
+    return get(h) != nullptr;
 }
 
-void Explosion::render(SplinterBuffer& sbuf, Renderer3D& r3d) {
-    for (size_t i = 0, e = shards_pos_.size(); i < e; ++i) {
-        tempModel_.vertices[0] = shards_p0_[i];
-        tempModel_.vertices[1] = shards_p1_[i];
-        r3d.renderModel(sbuf, shards_pos_[i], shards_rot_[i], scale,
-                        tempModel_);
+const Point3D& ParticleSystem::position(ParticleHandle h) const {
+    const Emitter* em = get(h);
+    dynamic_assert(em != nullptr, "stale explosion handle");
+    return em->pos;
+}
+
+void ParticleSystem::free(ParticleHandle h) {
+    if (!get(h)) return;
+    for (size_t i = 0, n = live_.size(); i < n; ++i) {
+        if (live_[i] == h.index) {
+            release(i);
+            return;
+        }
     }
 }
 
-void Explosion::adjustSpeed(coord_t s) {
-    for (size_t i = 0, e = shards_pos_.size(); i < e; ++i) {
-        shards_dpos_[i] *= s;
-        shards_drot_[i] *= s;
+void ParticleSystem::clear() {
+    while (!live_.empty()) release(live_.size() - 1);
+}
+
+// the loops over the shards are simple enough for the compiler to vectorize.
+// the turns are only recomputed (with sines and cosines) when delta changes
+bool ParticleSystem::updateEmitter(size_t e, float delta) {
+    Emitter& em = emitters_[e];
+    em.alpha -= delta * 0.4f * em.explspeed;
+    size_t base = e * maxShards;
+    Point3D* pos = &pos_[base];
+    const Point3D* dpos = &dpos_[base];
+    Quaternion* rot = &rot_[base];
+    Quaternion* step = &step_[base];
+    if (em.stepDelta != delta) {
+        const Point3D* spin = &spin_[base];
+        for (size_t i = 0, n = em.count; i < n; ++i)
+            step[i] = Quaternion::fromAngularVelocity(spin[i], delta);
+        em.stepDelta = delta;
+    }
+    for (size_t i = 0, n = em.count; i < n; ++i) {
+        pos[i] += dpos[i] * delta;
+        rot[i] = (rot[i] * step[i]).normalize();
     }
+    em.color.a = static_cast<uint8_t>(255 * std::sqrt(em.alpha));
+    return em.alpha > 0;
+}
+
+bool ParticleSystem::update(ParticleHandle h, float delta) {
+    if (!get(h)) return false;
+    if (updateEmitter(h.index, delta)) return true;
+    free(h);
+    return false;
+}
+
+void ParticleSystem::update(float delta) {
+    for (size_t i = 0; i < live_.size();) {
+        if (emitters_[live_[i]].detached || updateEmitter(live_[i], delta))
+            ++i;
+        else
+            release(i);
+    }
+}
+
+void ParticleSystem::move(const Point3D& d) {
+    for (uint16_t e : live_) {
+        Emitter& em = emitters_[e];
+        if (em.detached) continue;
+        em.pos += d;
+        Point3D* pos = &pos_[e * maxShards];
+        for (size_t i = 0, n = em.count; i < n; ++i) pos[i] += d;
+    }
+}
+
+void ParticleSystem::renderEmitter(size_t e, SplinterBuffer& sbuf,
+                                   Renderer3D& r3d) {
+    const Emitter& em = emitters_[e];
+    size_t base = e * maxShards;
+    r3d.renderLines(sbuf, em.count, &pos_[base], &rot_[base], &p0_[base],
+                    &p1_[base], Point3D(1, 1, 1), em.color);
+}
+
+void ParticleSystem::render(ParticleHandle h, SplinterBuffer& sbuf,
+                            Renderer3D& r3d) {
+    if (get(h)) renderEmitter(h.index, sbuf, r3d);
 }
 
-void Explosion::onMove(const Point3D& p) {
-    const Point3D& d = p - pos;
-    for (size_t i = 0, e = shards_pos_.size(); i < e; ++i) {
-        shards_pos_[i] += d;
+void ParticleSystem::render(SplinterBuffer& sbuf, Renderer3D& r3d,
+                            coord_t lateZ) {
+    for (uint16_t e : live_) {
+        const Emitter& em = emitters_[e];
+        if (!em.detached && em.pos.z < lateZ) renderEmitter(e, sbuf, r3d);
     }
 }
 
@@ -29,6 +29,7 @@ GameMain::GameMain(const ConfigSectionPtr<GameConfig>& config_,
       objectLateZ(farObjectBackPlane) {
     font_.setFont(getAssets().menuFont);
     ring_ = getGameModel(GameModel::Ring);
+    r3d_.reserveLines(maxShards);
     halt_ = 0.25;
     if (demo_)
         world_->difficulty_ = GameDifficulty{GameDifficultyLevel::Normal};
@@ -161,7 +162,7 @@ void GameMain::gotMessage(const GameMessage& msg) {
             cameraShake_ = msg.getFactor();
             shake1_ = Point3D{0, 0, 0};
             cameraShakeTime_ = 1;
-            cameraShakeSpeed_ = pow(cameraShake_, 1.25);
+            cameraShakeSpeed_ = pow(cameraShake_, coord_t(1.25));
             break;
         case GameMessageType::AddCredits:
             if (demo_) {
@@ -180,6 +181,22 @@ void GameMain::doExitGame() {
     sendMessage(AudioMessage::stopSounds());
 }
 
+void GameMain::endDemo(GameState& state) {
+    GameWorld& w = *world_;
+    std::string player = "player gone";
+    if (w.player) {
+        const Point3D& p = w.player->pos;
+        player = stringFormat("player at %.3f %.3f %.3f",
+                              static_cast<double>(p.x),
+                              static_cast<double>(p.y),
+                              static_cast<double>(p.z));
+    }
+    state.demoResult =
+        stringFormat("stage %d, section %u, score %lu, lives %d, %s",
+                     w.stageNum, w.sections, w.score, w.lives, player.c_str());
+    sendMessage(HostMessage::mainMenuFromDemo());
+}
+
 void GameMain::gotMessage(const MenuMessage& msg) {
     if (continue_) {
         if (msg.type == MenuMessageType::MenuSelect)
@@ -193,18 +210,6 @@ void GameMain::gotMessage(const MenuMessage& msg) {
     }
 }
 
-void GameMain::drawObject(GameState& state, float interval,
-                          const ObjectPtr& obj) {
-    if (obj->pos.z < objectLateZ) obj->render(state.sbuf, r3d_);
-}
-
-bool GameMain::updateObject(GameState& state, float interval,
-                            const ObjectPtr& obj) {
-    bool ok = obj->tick(*world_, interval);
-    if (ok) drawObject(state, interval, obj);
-    return ok;
-}
-
 void GameMain::doStageStart() {
     GameWorld& w = *world_;
     if (!demo_) {
@@ -412,8 +417,10 @@ void GameMain::doStageCompleteTick(GameState& state, float interval) {
         bonus_ = 0;
     }
     drawObjects(state, interval, w.objects);
+    w.particles.render(state.sbuf, r3d_, objectLateZ);
     drawObjects(state, interval, w.enemies);
     drawObjects(state, interval, w.enemyBullets);
+    drawBullets(state);
     drawObjects(state, interval, w.playerBullets);
     timer += interval;
     stageStartTimer = 0;
@@ -425,6 +432,16 @@ void GameMain::doStageCompleteTick(GameState& state, float interval) {
     }
 }
 
+void GameMain::drawBullets(GameState& state) {
+    world_->bulletSystem_.render(state.sbuf, r3d_, drawer_, objectLateZ);
+    drawer_.flush(state.sbuf, r3d_);
+}
+
+void GameMain::processBullets(GameState& state, float interval) {
+    world_->bulletSystem_.update(*world_, interval);
+    drawBullets(state);
+}
+
 void GameMain::doGameOver() {
     // game over
     gameOver_ = true;
@@ -520,7 +537,7 @@ bool GameMain::run(GameState& state, float interval) {
     }
     if (!running_) {
         if (demo_) {
-            sendMessage(HostMessage::mainMenuFromDemo());
+            endDemo(state);
             return false;
         }
         int rank = state.highScores.getHighscoreRank(w.score);
@@ -576,7 +593,7 @@ bool GameMain::run(GameState& state, float interval) {
             if (!demo_->runDemo(interval) || state.controls.fire ||
                 state.controls.pause) {
                 doExitGame();
-                sendMessage(HostMessage::mainMenuFromDemo());
+                endDemo(state);
                 return false;
             }
         }
@@ -628,10 +645,14 @@ bool GameMain::run(GameState& state, float interval) {
         }
         w.drawStage(state.sbuf, r3d_);
         objectLateZ = w.getObjectBackPlane();
+        // explosions started by the objects below wait for the next tick
+        w.particles.update(interval);
+        w.particles.render(state.sbuf, r3d_, objectLateZ);
         processObjects(state, interval, w.objects);
         processObjects(state, interval, w.enemies);
         objectLateZ = farObjectBackPlane;
         processObjects(state, interval, w.enemyBullets);
+        processBullets(state, interval);
         processObjects(state, interval, w.playerBullets);
         if (playerAlive) {
             w.renderPlayer(state.sbuf, r3d_, envRot);
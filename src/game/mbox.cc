@@ -69,30 +69,32 @@ bool MovingBox::update(GameWorld& w, float delta) {
     if (w.isPlayerAlive() && w.getPlayer().hits(*this)) {
         Point3D dir =
             collidesCuboidPointDirection(w.getPlayerPosition(), pos, scale);
-        w.getPlayer().wallContact(dir.x, dir.y, dir.z);
+        w.getPlayer().wallContact(w, dir.x, dir.y, dir.z);
     }
     absorbEnemies(w, w.getEnemies());
     absorbBullets(w, w.getPlayerBullets());
     absorbBullets(w, w.getEnemyBullets());
+    absorbBullets(w, w.getBulletSystem());
     return !isOffScreen();
 }
 
-void MovingBox::absorbBullets(GameWorld& w, const BulletList& list) {
-    for (const auto& bptr : list) {
+template <typename List>
+void MovingBox::absorbBullets(GameWorld& w, List& list) {
+    w.forEachNear(list, *this, [&](const auto& bptr) {
         if (bptr->hits(*this)) {
             bptr->backtrackCuboid(pos - scale, pos + scale);
             bptr->impact(w, false);
         }
-    }
+    });
 }
 
 void MovingBox::absorbEnemies(GameWorld& w, const EnemyList& list) {
-    for (const auto& e : list) {
+    w.forEachNear(list, *this, [&](const auto& e) {
         if (e->canHitWalls() && e->hits(*this)) {
             Point3D dir = collidesCuboidPointDirection(e->pos, pos, scale);
             e->hitWall(w, dir.x, dir.y, dir.z);
         }
-    }
+    });
 }
 
 }  // namespace hiemalia
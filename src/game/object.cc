@@ -35,7 +35,8 @@ void GameObject::move(coord_t x, coord_t y, coord_t z) {
 }
 
 void GameObject::render(SplinterBuffer& sbuf, Renderer3D& r3d) {
-    if (model_ != nullptr) r3d.renderModel(sbuf, pos, rot, scale, *model_);
+    if (model_ != nullptr)
+        r3d.renderModel(sbuf, getObjectModelMatrix(), scale, *model_);
 }
 
 bool GameObject::isInRegion(GameWorld& w, coord_t extentLeft,
@@ -46,8 +47,8 @@ bool GameObject::isInRegion(GameWorld& w, coord_t extentLeft,
            pos.y - extentTop >= r.y0 && pos.y + extentBottom <= r.y1;
 }
 
-Matrix3D GameObject::getObjectModelMatrix() const {
-    return Renderer3D::getModelMatrix(pos, rot, scale);
+const Matrix3DAffine& GameObject::getObjectModelMatrix() const {
+    return modelMatrix_.get(pos, rot, scale);
 }
 
 coord_t GameObject::getCollisionRadius() const { return collideRadius_; }
@@ -55,9 +56,16 @@ coord_t GameObject::getCollisionRadius() const { return collideRadius_; }
 void GameObject::setCollisionRadius(coord_t r) { collideRadius_ = r; }
 
 bool GameObject::hits(const GameObject& obj) const {
+    return nearby(obj) && (hitsSweep(obj) || hitsInternal(obj));
+}
+
+bool GameObject::nearby(const GameObject& obj) const {
     return collidesSphereSphere(pos, collideRadius_, obj.pos,
-                                obj.collideRadius_) &&
-           (hitsSweep(obj) || hitsInternal(obj));
+                                obj.collideRadius_);
+}
+
+bool GameObject::nearby(const Point3D& p, coord_t r) const {
+    return collidesSphereSphere(p, r, pos, collideRadius_);
 }
 
 bool GameObject::hitsSweep(const GameObject& obj) const {
@@ -77,6 +85,7 @@ void GameObject::setCollision(
     std::shared_ptr<const ModelCollision>&& collision) {
     collisionHolder_ = std::move(collision);
     collision_ = collisionHolder_.get();
+    worldCollision_.invalidate();
 }
 
 void GameObject::setModel(const Model& model) {
@@ -87,6 +96,7 @@ void GameObject::setModel(const Model& model) {
 void GameObject::setCollision(const ModelCollision& collision) {
     collision_ = &collision;
     collisionHolder_ = nullptr;
+    worldCollision_.invalidate();
 }
 
 void GameObject::noModel() {
@@ -97,6 +107,13 @@ void GameObject::noModel() {
 void GameObject::noCollision() {
     collision_ = nullptr;
     collisionHolder_ = nullptr;
+    worldCollision_.invalidate();
+}
+
+void GameObject::collisionChanged() { worldCollision_.invalidate(); }
+
+const ModelCollision& GameObject::worldCollision() const {
+    return worldCollision_.get(*collision_, getObjectModelMatrix());
 }
 
 void GameObject::useGameModel(GameModel m, bool collision /* = true */) {
@@ -153,15 +170,14 @@ bool ObjectDamageable::damage(GameWorld& w, float damage,
 
 static bool collidesLineObjectBasic(const Point3D& l1, const Point3D& l2,
                                     const GameObject& obj) {
-    return obj.hasCollision() && collidesLineModel(l1, l2, obj.collision(),
-                                                   obj.getObjectModelMatrix());
+    return obj.hasCollision() &&
+           collidesLineModel(l1, l2, obj.worldCollision());
 }
 
 static bool collidesCuboidObjectBasic(const Point3D& c1, const Point3D& c2,
                                       const GameObject& obj) {
     if (obj.hasCollision())
-        return collidesCuboidModel(c1, c2, obj.collision(),
-                                   obj.getObjectModelMatrix());
+        return collidesCuboidModel(c1, c2, obj.worldCollision());
     else
         return collidesPointCuboid(obj.pos, c1, c2);
 }
@@ -169,8 +185,7 @@ static bool collidesCuboidObjectBasic(const Point3D& c1, const Point3D& c2,
 static bool collidesSphereObjectBasic(const Point3D& c, coord_t r,
                                       const GameObject& obj) {
     if (obj.hasCollision())
-        return collidesSphereModel(c, r, obj.collision(),
-                                   obj.getObjectModelMatrix());
+        return collidesSphereModel(c, r, obj.worldCollision());
     else
         return collidesPointSphere(obj.pos, c, r);
 }
@@ -178,8 +193,7 @@ static bool collidesSphereObjectBasic(const Point3D& c, coord_t r,
 static bool collidesSweepSphereObjectBasic(const Point3D& c1, const Point3D& c2,
                                            coord_t r, const GameObject& obj) {
     if (obj.hasCollision())
-        return collidesSweepSphereModel(c1, c2, r, obj.collision(),
-                                        obj.getObjectModelMatrix());
+        return collidesSweepSphereModel(c1, c2, r, obj.worldCollision());
     else
         return collidesSweepSpherePoint(c1, c2, r, obj.pos);
 }
@@ -192,9 +206,7 @@ bool collidesLineObject(const Point3D& l1, const Point3D& l2,
         const auto& ex = obj.exCollisions();
         return std::any_of(
             ex.begin(), ex.end(), [&l1, &l2, &bpos](const ExtraCollision& c) {
-                return collidesLineModel(
-                    l1, l2, *c.collision,
-                    Renderer3D::getModelMatrix(bpos + c.pos, c.rot, c.scale));
+                return collidesLineModel(l1, l2, c.worldCollision(bpos));
             });
     }
     return false;
@@ -208,9 +220,7 @@ bool collidesCuboidObject(const Point3D& c1, const Point3D& c2,
         const auto& ex = obj.exCollisions();
         return std::any_of(
             ex.begin(), ex.end(), [&c1, &c2, &bpos](const ExtraCollision& c) {
-                return collidesCuboidModel(
-                    c1, c2, *c.collision,
-                    Renderer3D::getModelMatrix(bpos + c.pos, c.rot, c.scale));
+                return collidesCuboidModel(c1, c2, c.worldCollision(bpos));
             });
     }
     return false;
@@ -224,9 +234,7 @@ bool collidesSphereObject(const Point3D& c, coord_t r, const GameObject& obj) {
         return std::any_of(ex.begin(), ex.end(),
                            [&c, &r, &bpos](const ExtraCollision& cx) {
                                return collidesSphereModel(
-                                   c, r, *cx.collision,
-                                   Renderer3D::getModelMatrix(
-                                       bpos + cx.pos, cx.rot, cx.scale));
+                                   c, r, cx.worldCollision(bpos));
                            });
     }
     return false;
@@ -239,55 +247,63 @@ bool collidesSweepSphereObject(const Point3D& c1, const Point3D& c2, coord_t r,
     if (!obj.exCollisions().empty()) {
         Point3D bpos = obj.pos;
         const auto& ex = obj.exCollisions();
-        return std::any_of(
-            ex.begin(), ex.end(),
-            [&c1, &c2, &r, &bpos](const ExtraCollision& c) {
-                return collidesSweepSphereModel(
-                    c1, c2, r, *c.collision,
-                    Renderer3D::getModelMatrix(bpos + c.pos, c.rot, c.scale));
-            });
+        return std::any_of(ex.begin(), ex.end(),
+                           [&c1, &c2, &r, &bpos](const ExtraCollision& c) {
+                               return collidesSweepSphereModel(
+                                   c1, c2, r, c.worldCollision(bpos));
+                           });
     }
     return false;
 }
 
+SweepImpact collidesSweepSphereObjectImpact(const Point3D& c1,
+                                            const Point3D& c2, coord_t r,
+                                            const GameObject& obj) {
+    SweepImpact best =
+        obj.hasCollision()
+            ? collidesSweepSphereModelImpact(c1, c2, r, obj.worldCollision())
+            : collidesSweepSphereSphereImpact(c1, c2, r, obj.pos, 0);
+    for (const ExtraCollision& c : obj.exCollisions()) {
+        SweepImpact s = collidesSweepSphereModelImpact(
+            c1, c2, r, c.worldCollision(obj.pos));
+        if (s.hit && (!best.hit || s.t < best.t)) best = s;
+    }
+    return best;
+}
+
 static bool collidesObjectObjectBasic(const GameObject& obj1,
                                       const GameObject& obj2) {
     if (obj1.hasCollision() && obj2.hasCollision())
-        return collidesModelModel(obj1.collision(), obj1.getObjectModelMatrix(),
-                                  obj2.collision(),
-                                  obj2.getObjectModelMatrix());
+        return collidesModelModel(obj1.worldCollision(),
+                                  obj2.worldCollision());
     else
         return false;
 }
 
-bool collidesExModelObject(const ModelCollision& c1, const Matrix3D& mat1,
-                           const GameObject& obj2) {
-    if (obj2.hasCollision() && collidesModelModel(c1, mat1, obj2.collision(),
-                                                  obj2.getObjectModelMatrix()))
+// c1 is in world space
+static bool collidesExModelObject(const ModelCollision& c1,
+                                  const GameObject& obj2) {
+    if (obj2.hasCollision() &&
+        collidesModelModel(c1, obj2.worldCollision()))
         return true;
     const auto& ex2 = obj2.exCollisions();
     Point3D bpos2 = obj2.pos;
-    return std::any_of(
-        ex2.begin(), ex2.end(), [&bpos2, &c1, &mat1](const ExtraCollision& c) {
-            return collidesModelModel(
-                c1, mat1, *c.collision,
-                Renderer3D::getModelMatrix(bpos2 + c.pos, c.rot, c.scale));
-        });
+    return std::any_of(ex2.begin(), ex2.end(),
+                       [&bpos2, &c1](const ExtraCollision& c) {
+                           return collidesModelModel(c1,
+                                                     c.worldCollision(bpos2));
+                       });
 }
 
 bool collidesObjectObject(const GameObject& obj1, const GameObject& obj2) {
     if (!obj1.exCollisions().empty() || !obj2.exCollisions().empty()) {
         const auto& ex1 = obj1.exCollisions();
         Point3D bpos1 = obj1.pos;
-        return collidesExModelObject(obj1.collision(),
-                                     obj1.getObjectModelMatrix(), obj2) ||
+        return collidesExModelObject(obj1.worldCollision(), obj2) ||
                std::any_of(ex1.begin(), ex1.end(),
                            [&bpos1, &obj2](const ExtraCollision& c) {
                                return collidesExModelObject(
-                                   *c.collision,
-                                   Renderer3D::getModelMatrix(bpos1 + c.pos,
-                                                              c.rot, c.scale),
-                                   obj2);
+                                   c.worldCollision(bpos1), obj2);
                            });
     }
     return collidesObjectObjectBasic(obj1, obj2);
@@ -29,40 +29,38 @@
 
 namespace hiemalia {
 template <typename T>
-std::shared_ptr<GameObject> makeStandardObject(const Point3D& p,
-                                               const std::string& prop) {
-    return std::make_shared<T>(p);
+PoolPtr<GameObject> makeStandardObject(const Point3D& p,
+                                       const std::string& prop) {
+    return makePooled<T>(p);
 }
 
 template <typename T>
-std::shared_ptr<GameObject> makePropObject(const Point3D& p,
-                                           const std::string& prop) {
-    return std::make_shared<T>(p, prop);
+PoolPtr<GameObject> makePropObject(const Point3D& p, const std::string& prop) {
+    return makePooled<T>(p, prop);
 }
 
 template <typename T>
-std::shared_ptr<GameObject> makeTwoPosObject(const Point3D& p,
-                                             const std::string& prop) {
+PoolPtr<GameObject> makeTwoPosObject(const Point3D& p,
+                                     const std::string& prop) {
     coord_t sx = 0, sy = 0, sz = 0;
     if (s_sscanf(prop.c_str(), FMT_coord_t " " FMT_coord_t " " FMT_coord_t, &sx,
                  &sy, &sz) < 3)
         LOG_WARN("invalid two-pos object prop");
-    return std::make_shared<T>(p, Point3D(sx, sy, sz));
+    return makePooled<T>(p, Point3D(sx, sy, sz));
 }
 
 template <typename T>
-std::shared_ptr<GameObject> makeAngleObject(const Point3D& p,
-                                            const std::string& prop) {
+PoolPtr<GameObject> makeAngleObject(const Point3D& p, const std::string& prop) {
     coord_t sx = 0, sy = 0, sz = 0;
     if (s_sscanf(prop.c_str(), FMT_coord_t " " FMT_coord_t " " FMT_coord_t, &sx,
                  &sy, &sz) < 3)
         LOG_WARN("invalid angled object prop");
-    return std::make_shared<T>(p, Orient3D(sx, sy, sz));
+    return makePooled<T>(p, Orient3D(sx, sy, sz));
 }
 
 template <typename T>
-std::shared_ptr<GameObject> makeAngleVelObject(const Point3D& p,
-                                               const std::string& prop) {
+PoolPtr<GameObject> makeAngleVelObject(const Point3D& p,
+                                       const std::string& prop) {
     coord_t sx1 = 0, sy1 = 0, sz1 = 0;
     coord_t sx2 = 0, sy2 = 0, sz2 = 0;
     if (s_sscanf(prop.c_str(),
@@ -70,8 +68,7 @@ std::shared_ptr<GameObject> makeAngleVelObject(const Point3D& p,
                              " " FMT_coord_t " " FMT_coord_t,
                  &sx1, &sy1, &sz1, &sx2, &sy2, &sz2) < 6)
         LOG_WARN("invalid angled object prop");
-    return std::make_shared<T>(p, Orient3D(sx1, sy1, sz1),
-                               Orient3D(sx2, sy2, sz2));
+    return makePooled<T>(p, Orient3D(sx1, sy1, sz1), Orient3D(sx2, sy2, sz2));
 }
 
 namespace {
@@ -90,40 +87,41 @@ void streamExtractCopy_(std::istream& ss, Td& out) {
 }
 
 template <typename T, typename Ta, std::size_t... I>
-std::shared_ptr<GameObject> makeCoordPropObject_(const Point3D& p,
-                                                 const std::string& prop,
-                                                 std::index_sequence<I...>) {
+PoolPtr<GameObject> makeCoordPropObject_(const Point3D& p,
+                                         const std::string& prop,
+                                         std::index_sequence<I...>) {
     std::array<Ta, sizeof...(I)> arr;
     std::istringstream ss{prop};
     (streamExtract_<Ta>(ss, arr[I]), ...);
-    return std::make_shared<T>(p, arr[I]...);
+    return makePooled<T>(p, arr[I]...);
 }
 
 template <typename T, typename... Ts, std::size_t... I>
-std::shared_ptr<GameObject> makeArgPropObject_(
-    const Point3D& p, std::array<std::any, sizeof...(I)>& v,
-    const std::string& prop, std::index_sequence<I...>) {
+PoolPtr<GameObject> makeArgPropObject_(const Point3D& p,
+                                       std::array<std::any, sizeof...(I)>& v,
+                                       const std::string& prop,
+                                       std::index_sequence<I...>) {
     // contrived^2
     using TTuple = std::tuple<Ts...>;
     std::istringstream ss{prop};
     (streamExtractCopy_<typename std::tuple_element<I, TTuple>::type>(ss, v[I]),
      ...);
-    return std::make_shared<T>(
+    return makePooled<T>(
         p,
         std::any_cast<typename std::tuple_element<I, TTuple>::type>(v[I])...);
 }
 }  // namespace
 
 template <typename T, std::size_t N>
-std::shared_ptr<GameObject> makeCoordPropObject(const Point3D& p,
-                                                const std::string& prop) {
+PoolPtr<GameObject> makeCoordPropObject(const Point3D& p,
+                                        const std::string& prop) {
     using I = std::make_index_sequence<N>;
     return makeCoordPropObject_<T, coord_t>(p, prop, I{});
 }
 
 template <typename T, typename... Ts>
-std::shared_ptr<GameObject> makeArgPropObject(const Point3D& p,
-                                              const std::string& prop) {
+PoolPtr<GameObject> makeArgPropObject(const Point3D& p,
+                                      const std::string& prop) {
     // contrived
     using I = std::make_index_sequence<sizeof...(Ts)>;
     std::array<std::any, sizeof...(Ts)> v;
@@ -131,17 +129,17 @@ std::shared_ptr<GameObject> makeArgPropObject(const Point3D& p,
 }
 
 template <GameModel V>
-std::shared_ptr<GameObject> makeObstacleObject(const Point3D& p,
-                                               const std::string& prop) {
+PoolPtr<GameObject> makeObstacleObject(const Point3D& p,
+                                       const std::string& prop) {
     coord_t sx = 0, sy = 0, sz = 0;
     if (s_sscanf(prop.c_str(), FMT_coord_t " " FMT_coord_t " " FMT_coord_t, &sx,
                  &sy, &sz) < 3)
         LOG_WARN("invalid angled object prop");
-    return std::make_shared<Obstacle>(p, Orient3D(sx, sy, sz), V);
+    return makePooled<Obstacle>(p, Orient3D(sx, sy, sz), V);
 }
 
-using object_maker_t = std::function<std::shared_ptr<GameObject>(
-    const Point3D&, const std::string&)>;
+using object_maker_t =
+    std::function<PoolPtr<GameObject>(const Point3D&, const std::string&)>;
 
 static const std::unordered_map<std::string, object_maker_t> nameMap = {
     {"checkpoint", makeStandardObject<CheckpointScript>},
@@ -195,8 +193,8 @@ static const std::unordered_map<std::string, object_maker_t> nameMap = {
     {"boss7", makeStandardObject<EnemyBoss7>},
 };
 
-std::shared_ptr<GameObject> loadObjectSpawn(Point3D p, const std::string& name,
-                                            const std::string& prop) {
+PoolPtr<GameObject> loadObjectSpawn(Point3D p, const std::string& name,
+                                    const std::string& prop) {
     auto it = nameMap.find(name);
     if (it == nameMap.end()) {
         never("unrecognized object name");
@@ -22,21 +22,23 @@ Obstacle::Obstacle(const Point3D& pos, const Orient3D& r, GameModel model)
     rot = r;
 }
 
-void Obstacle::absorbBullets(GameWorld& w, const BulletList& list) {
-    for (const auto& bptr : list) {
-        if (bptr->hits(*this)) {
-            bptr->backtrackObject(*this);
+template <typename List>
+void Obstacle::absorbBullets(GameWorld& w, List& list) {
+    w.forEachNear(list, *this, [&](const auto& bptr) {
+        SweepImpact hit = bptr->impactOn(*this);
+        if (hit.hit) {
+            bptr->backtrack(hit);
             bptr->impact(w, false);
         }
-    }
+    });
 }
 
 void Obstacle::absorbEnemies(GameWorld& w, const EnemyList& list) {
-    for (const auto& e : list) {
+    w.forEachNear(list, *this, [&](const auto& e) {
         if (e->canHitWalls() && e->hits(*this)) {
             e->hitWall(w, 0, 0, 0);
         }
-    }
+    });
 }
 
 bool Obstacle::update(GameWorld& w, float delta) {
@@ -44,12 +46,13 @@ bool Obstacle::update(GameWorld& w, float delta) {
     if (w.isPlayerAlive()) {
         PlayerObject& p = w.getPlayer();
         if (hits(p)) {
-            p.enemyContact();
+            p.enemyContact(w);
         }
     }
     absorbEnemies(w, w.getEnemies());
     absorbBullets(w, w.getPlayerBullets());
     absorbBullets(w, w.getEnemyBullets());
+    absorbBullets(w, w.getBulletSystem());
     return !isOffScreen();
 }
 
@@ -57,14 +60,16 @@ DestroyableObstacle::DestroyableObstacle(const Point3D& pos, const Orient3D& r,
                                          GameModel model, float health)
     : Obstacle(pos, r, model), ObjectDamageable(health) {}
 
-void DestroyableObstacle::absorbBullets(GameWorld& w, const BulletList& list) {
-    for (const auto& bptr : list) {
-        if (bptr->hits(*this)) {
-            bptr->backtrackObject(*this);
+template <typename List>
+void DestroyableObstacle::absorbBullets(GameWorld& w, List& list) {
+    w.forEachNear(list, *this, [&](const auto& bptr) {
+        SweepImpact hit = bptr->impactOn(*this);
+        if (hit.hit) {
+            bptr->backtrack(hit);
             damage(w, bptr->getDamage(), bptr->pos);
             bptr->impact(w, false);
         }
-    }
+    });
 }
 
 bool DestroyableObstacle::update(GameWorld& w, float delta) {
@@ -72,12 +77,13 @@ bool DestroyableObstacle::update(GameWorld& w, float delta) {
     if (w.isPlayerAlive()) {
         PlayerObject& p = w.getPlayer();
         if (hits(p)) {
-            p.enemyContact();
+            p.enemyContact(w);
         }
     }
     absorbEnemies(w, w.getEnemies());
     absorbBullets(w, w.getPlayerBullets());
     absorbBullets(w, w.getEnemyBullets());
+    absorbBullets(w, w.getBulletSystem());
     return !isOffScreen();
 }
 
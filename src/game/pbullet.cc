@@ -22,12 +22,10 @@ PlayerBullet::PlayerBullet(const Point3D& pos, const Point3D& v)
 }
 
 bool PlayerBullet::doBulletTick(GameWorld& w, float delta) {
-    for (const auto& eptr : w.getEnemies()) {
-        if (hits(*eptr)) {
-            Point3D c = lerp(0.5);
-            impact(w, eptr->hitBullet(w, getDamage(), c));
-        }
-    }
+    w.forEachNear(w.getEnemies(), *this, [&](const auto& eptr) {
+        SweepImpact hit = impactOn(*eptr);
+        if (hit.hit) impact(w, eptr->hitBullet(w, getDamage(), hit.contact));
+    });
     return true;
 }
 
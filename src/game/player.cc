@@ -49,10 +49,13 @@ void PlayerObject::onDeath(GameWorld& w) {
     woundedBird_ = true;
 }
 
-void PlayerObject::enemyContact() { wallContact(0, 0, 0); }
+void PlayerObject::enemyContact(GameWorld& w) { wallContact(w, 0, 0, 0); }
 
-void PlayerObject::wallContact(coord_t x, coord_t y, coord_t z) {
-    explodeObject_ = std::make_unique<Explosion>(pos, *this, x, y, z, 1.0f);
+void PlayerObject::wallContact(GameWorld& w, coord_t x, coord_t y,
+                               coord_t z) {
+    ParticleSystem& particles = w.getParticles();
+    particles.free(explosion_);
+    explosion_ = particles.explode(pos, *this, x, y, z, 1.0f, true);
 }
 
 void PlayerObject::updateInput(const ControlState& controls) {
@@ -113,46 +116,45 @@ void PlayerObject::checkBounds(const MoveRegion& r, const MoveRegion& r0,
         if (vel.y < 0) vel.y = 0;
         pos.y = r.y0;
         if (r.y0 - r0.y0 >= 0.25)
-            wallContact(0, 0, -1);
+            wallContact(w, 0, 0, -1);
         else
-            wallContact(0, 1, 0);
+            wallContact(w, 0, 1, 0);
         return;
     }
     if (pos.y + shipRadius_ * 0.5 > r.y1) {
         if (vel.y > 0) vel.y = 0;
         pos.y = r.y1;
         if (r0.y1 - r.y1 >= 0.25)
-            wallContact(0, 0, -1);
+            wallContact(w, 0, 0, -1);
         else
-            wallContact(0, -1, 0);
+            wallContact(w, 0, -1, 0);
         return;
     }
     if (pos.x - shipRadius_ < r.x0) {
         if (vel.x < 0) vel.x = 0;
         pos.x = r.x0;
         if (r.x0 - r0.x0 >= 0.25)
-            wallContact(0, 0, -1);
+            wallContact(w, 0, 0, -1);
         else
-            wallContact(1, 0, 0);
+            wallContact(w, 1, 0, 0);
         return;
     }
     if (pos.x + shipRadius_ > r.x1) {
         if (vel.x > 0) vel.x = 0;
         pos.x = r.x1;
         if (r0.x1 - r.x1 >= 0.25)
-            wallContact(0, 0, -1);
+            wallContact(w, 0, 0, -1);
         else
-            wallContact(-1, 0, 0);
+            wallContact(w, -1, 0, 0);
         return;
     }
 }
 
 void PlayerObject::render(SplinterBuffer& sbuf, Renderer3D& r3d) {
-    GameObject::render(sbuf, r3d);
-    if (woundedBird_) {
-        r3d.renderModel(sbuf, pos, rot, scale,
-                        *getGameModel(GameModel::CrackedWindow).model);
-    }
+    ModelPart parts[] = {{hasModel() ? &model() : nullptr},
+                         {getGameModel(GameModel::CrackedWindow).model.get()}};
+    r3d.renderModels(sbuf, getObjectModelMatrix(), scale, parts,
+                     woundedBird_ ? 2 : 1);
 }
 
 bool PlayerObject::playerInControl() const { return !woundedBird_; }
@@ -170,7 +172,7 @@ void PlayerObject::doWoundedBird(float delta) {
 void PlayerObject::doFire(GameWorld& w) {
     fireInterval_ = 0.2f;
     sendMessage(AudioMessage::playSound(SoundEffect::PlayerFire));
-    Matrix3D mat = getObjectModelMatrix();
+    const Matrix3DAffine& mat = getObjectModelMatrix();
     Point3D leftTurret = mat.project(Point3D(-2, 0.0625, 0.25) * 0.0625);
     Point3D rightTurret = mat.project(Point3D(2, 0.0625, 0.25) * 0.0625);
     Point3D target = pos + Point3D(0, 0, farObjectBackPlane * 1.5);
@@ -181,8 +183,8 @@ void PlayerObject::doFire(GameWorld& w) {
 }
 
 bool PlayerObject::update(GameWorld& w, float delta) {
-    if (explodeObject_) {
-        auto obj = w.explodePlayer(std::move(explodeObject_));
+    if (explosion_) {
+        auto obj = w.explodePlayer(explosion_);
         return true;
     }
     inputsVelocity(delta);
@@ -0,0 +1,47 @@
+/****************************************************************************/
+/*                                                                          */
+/*   HIEMALIA SOURCE CODE (C) 2021      SAMPO HIPPELAINEN (HISAHI).         */
+/*   SEE THE LICENSE FILE IN THE SOURCE ROOT DIRECTORY FOR LICENSE INFO.    */
+/*                                                                          */
+/****************************************************************************/
+// game/pool.cc: implementation of object pools
+
+#include "game/pool.hh"
+
+#include "stats.hh"
+
+namespace hiemalia {
+
+static uint32_t nextPoolId = 0;
+
+ObjectPool::ObjectPool(size_t size, size_t align)
+    : id_(nextPoolId++), size_((size + align - 1) / align * align) {
+    // the chunks are allocated with new[]
+    dynamic_assert(align <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                   "object type is overaligned");
+}
+
+uint32_t ObjectPool::allocate() {
+    perfStats.add(Stat::ObjectsPooled);
+    if (free_.empty()) {
+        perfStats.add(Stat::ObjectPoolChunks);
+        uint32_t first = static_cast<uint32_t>(generations_.size());
+        chunks_.emplace_back(new unsigned char[size_ * objectPoolChunk]);
+        generations_.resize(first + objectPoolChunk, 0);
+        // free never has to grow free_
+        free_.reserve(generations_.size());
+        // the lowest index goes out first
+        for (size_t i = objectPoolChunk; i > 0; --i)
+            free_.push_back(first + static_cast<uint32_t>(i - 1));
+    }
+    uint32_t index = free_.back();
+    free_.pop_back();
+    return index;
+}
+
+void ObjectPool::free(uint32_t index) noexcept {
+    ++generations_[index];
+    free_.push_back(index);
+}
+
+}  // namespace hiemalia
@@ -61,25 +61,26 @@ SlidingBox::SlidingBox(const Point3D& pos, coord_t dir, coord_t x0, coord_t y0,
     collision_->shapes.push_back(CollisionShape::cuboid(*pmin_, *pmax_));
     collision_->shapes[0].p.z = std::min(z0, z1);
     collision_->shapes[0].p1.z = std::max(z0, z1);
+    collision_->update();
 }
 
 void SlidingBox::absorbBullets(GameWorld& w, const BulletList& list) {
-    for (const auto& bptr : list) {
+    w.forEachNear(list, *this, [&](const auto& bptr) {
         if (hits(*bptr)) {
             bptr->backtrackCuboid(pos + *pmin_, pos + *pmax_);
             bptr->impact(w, false);
         }
-    }
+    });
 }
 
 void SlidingBox::absorbEnemies(GameWorld& w, const EnemyList& list,
                                const Point3D& avg, const Point3D& siz) {
-    for (const auto& e : list) {
+    w.forEachNear(list, *this, [&](const auto& e) {
         if (e->hits(*this)) {
             Point3D dir = collidesCuboidPointDirection(e->pos, avg, siz);
             e->hitWall(w, dir.x, dir.y, dir.z);
         }
-    }
+    });
 }
 
 void SlidingBox::updateBox() {
@@ -102,11 +103,14 @@ void SlidingBox::updateBox() {
     v[13].x = x0, v[13].y = y0;
     v[14].x = x0, v[14].y = y1;
     v[15].x = x1, v[15].y = y0;
+    model_->refresh();
 
     collision_->shapes[0].p.x = x0;
     collision_->shapes[0].p.y = y0;
     collision_->shapes[0].p1.x = x1;
     collision_->shapes[0].p1.y = y1;
+    collision_->update();
+    collisionChanged();
 }
 
 coord_t SlidingBox::getLerp(coord_t t) { return t >= 0.5 ? 2 - t * 2 : t * 2; }
@@ -120,11 +124,13 @@ bool SlidingBox::update(GameWorld& w, float delta) {
     if (w.isPlayerAlive() && w.getPlayer().hits(*this)) {
         Point3D dir =
             collidesCuboidPointDirection(w.getPlayerPosition(), avg, siz);
-        w.getPlayer().wallContact(dir.x, dir.y, dir.z);
+        w.getPlayer().wallContact(w, dir.x, dir.y, dir.z);
     }
     absorbEnemies(w, w.getEnemies(), avg, siz);
     absorbBullets(w, w.getPlayerBullets());
     absorbBullets(w, w.getEnemyBullets());
+    // the bullets in getBulletSystem have no collision shapes, which
+    // hits(*bptr) needs, so they are not absorbed here
     return !isOffScreen();
 }
 
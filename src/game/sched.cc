@@ -0,0 +1,165 @@
+/****************************************************************************/
+/*                                                                          */
+/*   HIEMALIA SOURCE CODE (C) 2021      SAMPO HIPPELAINEN (HISAHI).         */
+/*   SEE THE LICENSE FILE IN THE SOURCE ROOT DIRECTORY FOR LICENSE INFO.    */
+/*                                                                          */
+/****************************************************************************/
+// game/sched.cc: implementation of the object update loops
+
+#include "game/sched.hh"
+
+#include <type_traits>
+#include <utility>
+
+#include "game/box.hh"
+#include "game/checkpnt.hh"
+#include "game/emissile.hh"
+#include "game/enemy.hh"
+#include "game/enemy/all.hh"
+#include "game/gameend.hh"
+#include "game/mbox.hh"
+#include "game/obstacle.hh"
+#include "game/pbullet.hh"
+#include "game/sbox.hh"
+#include "game/setspeed.hh"
+#include "game/stageend.hh"
+#include "game/world.hh"
+#include "stats.hh"
+
+namespace hiemalia {
+
+// a run of instances is never longer than a list
+ObjectDrawer::ObjectDrawer() { instances_.reserve(objectsMax); }
+
+void ObjectDrawer::drawInstance(SplinterBuffer& sbuf, Renderer3D& r3d,
+                                const Model& m, const ModelTransform& t) {
+    if (&m != model_) flush(sbuf, r3d);
+    model_ = &m;
+    instances_.push_back(t);
+}
+
+void ObjectDrawer::add(SplinterBuffer& sbuf, Renderer3D& r3d,
+                       const GameObject& obj, const Model& m) {
+    drawInstance(sbuf, r3d, m,
+                 {obj.pos, obj.rot, obj.scale, &obj.getObjectModelMatrix()});
+}
+
+void ObjectDrawer::flush(SplinterBuffer& sbuf, Renderer3D& r3d) {
+    if (model_)
+        r3d.renderInstances(sbuf, *model_, instances_.data(),
+                            instances_.size());
+    instances_.clear();
+    model_ = nullptr;
+}
+
+template <typename T>
+using ObjectLoop = PoolPtr<T>* (*)(ObjectPass& pass, PoolPtr<T>* first,
+                                   PoolPtr<T>* last, PoolPtr<T>* out);
+
+// the loop for the objects made as U in a list of T. with U = T, the type
+// is not known and the calls go through the vtable
+template <typename U, typename T>
+static PoolPtr<T>* updateRun(ObjectPass& pass, PoolPtr<T>* first,
+                             PoolPtr<T>* last, PoolPtr<T>* out) {
+    for (; first != last; ++first) {
+        U& obj = static_cast<U&>(**first);
+        if constexpr (std::is_same_v<U, T>) {
+            if (!obj.tick(pass.world, pass.delta)) continue;
+            if (obj.pos.z < pass.lateZ)
+                pass.drawer.draw(pass.sbuf, pass.r3d, obj);
+        } else {
+            if (!obj.template tickAs<U>(pass.world, pass.delta)) continue;
+            if (obj.pos.z < pass.lateZ)
+                pass.drawer.drawAs(pass.sbuf, pass.r3d, obj);
+        }
+        if (out != first) *out = std::move(*first);
+        ++out;
+    }
+    return out;
+}
+
+// the loops for one kind of list, by ObjectPool::id
+template <typename T>
+class ObjectLoops {
+  public:
+    template <typename... Us>
+    static ObjectLoops of() {
+        ObjectLoops loops;
+        (loops.add(objectPool<Us>(), &updateRun<Us, T>), ...);
+        return loops;
+    }
+
+    inline ObjectLoop<T> find(const ObjectPool& pool) const {
+        uint32_t i = pool.id();
+        return i < loops_.size() && loops_[i] ? loops_[i] : &updateRun<T, T>;
+    }
+
+  private:
+    std::vector<ObjectLoop<T>> loops_;
+
+    void add(const ObjectPool& pool, ObjectLoop<T> loop) {
+        if (pool.id() >= loops_.size()) loops_.resize(pool.id() + 1, nullptr);
+        loops_[pool.id()] = loop;
+    }
+};
+
+// every type that is spawned into a list should be here, in the list of the
+// base class of that list. the others still work, but slower
+static const auto objectLoops = ObjectLoops<GameObject>::of<
+    CheckpointScript, StageEndScript, GameEndScript, SetSpeedScript,
+    Boss4Script, Obstacle, DestroyableObstacle, Box, DestroyableBox,
+    MovingBox, SlidingBox, SlidingBoxSine>();
+
+static const auto enemyLoops = ObjectLoops<EnemyObject>::of<
+    EnemyBlocker, EnemyBoss0, EnemyBoss1, EnemyBoss2, EnemyBoss3,
+    EnemyFuzzball, EnemyBoss4, EnemyBoss5, EnemyBoss6, EnemyBoss7,
+    EnemyBouncer, EnemyChevron, EnemyDestroyer, EnemyFighter, EnemyGunboat,
+    EnemyGunboat2, EnemyLauncher, EnemyOrbiter, EnemyPewpew, EnemyPod,
+    EnemyRammer, EnemyShard, EnemySpider, EnemySpreadTurret, EnemyTurret,
+    EnemyVolcano, EnemyWalker, EnemyWasp, EnemyWave, EnemyWheeledTurret,
+    EnemyZoomer>();
+
+static const auto bulletLoops = ObjectLoops<BulletObject>::of<
+    PlayerBullet, EnemyBulletBounce, EnemyMissileHoming>();
+
+static const ObjectLoops<GameObject>& loopsOf(const PoolPtr<GameObject>*) {
+    return objectLoops;
+}
+
+static const ObjectLoops<EnemyObject>& loopsOf(const PoolPtr<EnemyObject>*) {
+    return enemyLoops;
+}
+
+static const ObjectLoops<BulletObject>& loopsOf(
+    const PoolPtr<BulletObject>*) {
+    return bulletLoops;
+}
+
+template <typename T>
+PoolPtr<T>* updateObjects(ObjectPass& pass, PoolPtr<T>* first,
+                          PoolPtr<T>* last) {
+    const ObjectLoops<T>& loops = loopsOf(first);
+    PoolPtr<T>* out = first;
+    while (first != last) {
+        // the objects made in one pool all have the same type
+        const ObjectPool* pool = first->pool();
+        PoolPtr<T>* end = first + 1;
+        while (end != last && end->pool() == pool) ++end;
+        perfStats.add(Stat::ObjectRuns);
+        out = loops.find(*pool)(pass, first, end, out);
+        first = end;
+    }
+    return out;
+}
+
+template PoolPtr<GameObject>* updateObjects(ObjectPass& pass,
+                                            PoolPtr<GameObject>* first,
+                                            PoolPtr<GameObject>* last);
+template PoolPtr<EnemyObject>* updateObjects(ObjectPass& pass,
+                                             PoolPtr<EnemyObject>* first,
+                                             PoolPtr<EnemyObject>* last);
+template PoolPtr<BulletObject>* updateObjects(ObjectPass& pass,
+                                              PoolPtr<BulletObject>* first,
+                                              PoolPtr<BulletObject>* last);
+
+}  // namespace hiemalia
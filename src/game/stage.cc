@@ -8,7 +8,9 @@
 
 #include "game/stage.hh"
 
+#include <algorithm>
 #include <cstdlib>
+#include <iterator>
 
 #include "assets.hh"
 #include "collide.hh"
@@ -38,19 +40,24 @@ void GameStage::nextSection() {
     if (overridden_) {
         size_t i = overrideIndex_;
         if (i + 1 < overrideSec_.size()) ++overrideIndex_;
-        visible_.push_back(overrideSec_[i]);
+        pushVisible(overrideSec_[i]);
         return;
     }
     if (inBoss_) {
-        visible_.push_back(bossLoop_[inBossIndex_]);
+        pushVisible(bossLoop_[inBossIndex_]);
         inBossIndex_ = (inBossIndex_ + 1) % bossLoop_.size();
         return;
     }
     if (nextSection_ >= sections_.size()) {
-        visible_.push_back(sectionsLoop_[nextSectionLoop_]);
+        pushVisible(sectionsLoop_[nextSectionLoop_]);
         nextSectionLoop_ = (nextSectionLoop_ + 1) % sectionsLoop_.size();
     } else
-        visible_.push_back(sections_[nextSection_++]);
+        pushVisible(sections_[nextSection_++]);
+}
+
+void GameStage::pushVisible(section_t section) {
+    visible_.push_back(section);
+    geometry_.push(getSectionById(section).model);
 }
 
 bool GameStage::shouldSpawnNext(unsigned i, coord_t f) const {
@@ -75,25 +82,93 @@ coord_t GameStage::getObjectBackPlane(coord_t offset) const {
 
 void GameStage::drawStage(SplinterBuffer& sbuf, Renderer3D& r3d,
                           coord_t offset) {
-    int i = stageSectionOffset;
-    Point3D p = Point3D(0, 0, stageSectionOffset * stageSectionLength - offset);
-    Point3D v = Point3D(0, 0, stageSectionLength);
-    Orient3D r = Orient3D(0, 0, 0);
-    // Matrix3D m;
-    static const Point3D s = Point3D(1, 1, 1);
-    for (auto section : visible_) {
-        const GameSection& sec = getSectionById(section);
-        // m = Matrix3D::rotate(r);
-        r3d.renderModel(sbuf, p, r, s, sec.model);
-        /*if (i < 0)
-            p += v;
-        else {
-            p += m.project(v);
-            r += sec.rotation;
-        }*/
-        p += v;
-        ++i;
+    geometry_.render(sbuf, r3d,
+                     stageSectionOffset * stageSectionLength - offset);
+}
+
+// reserves room for the largest sections, so that scrolling does not
+// allocate. compact keeps fewer dropped vertices and shapes than visible ones,
+// so the arrays never hold more than twice the visible sections and the one
+// being pushed
+StageGeometry::StageGeometry() {
+    size_t vertices = 0, shapes = 0, points = 0;
+    for (const auto& section : getAssets().sectionData) {
+        if (!section) continue;
+        const Model& m = section->model;
+        vertices = std::max(vertices, m.vertices.size());
+        shapes = std::max(shapes, m.shapes.size());
+        for (const ModelFragment& f : m.shapes)
+            points = std::max(points, f.points.size());
+    }
+    size_t sections = 2 * stageVisibility + 1;
+    vertices_.x.reserve(sections * vertices);
+    vertices_.y.reserve(sections * vertices);
+    vertices_.z.reserve(sections * vertices);
+    shapes_.reserve(sections * shapes);
+    sparePoints_.resize(sections * shapes);
+    for (std::vector<size_t>& p : sparePoints_) p.reserve(points);
+}
+
+void StageGeometry::push(const Model& model) {
+    // the section that push_back drops stays in the arrays; render just
+    // starts after it
+    if (visible_.size() == visible_.capacity()) {
+        vertexBase_ += visible_.front().vertices;
+        shapeBase_ += visible_.front().shapes;
+    }
+    visible_.push_back({model.vertices.size(), model.shapes.size()});
+    ++pushed_;
+    if (vertexBase_ >= vertices_.size() - vertexBase_ ||
+        shapeBase_ >= shapes_.size() - shapeBase_)
+        compact();
+    size_t base = vertices_.size();
+    coord_t z = (pushed_ - 1) * stageSectionLength;
+    for (const Point3D& v : model.vertices) {
+        vertices_.x.push_back(v.x);
+        vertices_.y.push_back(v.y);
+        vertices_.z.push_back(v.z + z);
     }
+    for (const ModelFragment& f : model.shapes) {
+        std::vector<size_t> points;
+        if (!sparePoints_.empty()) {
+            points = std::move(sparePoints_.back());
+            sparePoints_.pop_back();
+            points.clear();
+        }
+        points.reserve(f.points.size());
+        for (size_t i : f.points) points.push_back(i + base);
+        shapes_.emplace_back(f.color, f.start + base, std::move(points));
+    }
+}
+
+// removes the dropped sections once they take as much room as the visible
+// ones, so that each vertex is moved only a constant number of times. also
+// moves the z origin to the first visible section so that z stays small
+// enough for the section models to stay exact
+void StageGeometry::compact() {
+    size_t nv = vertexBase_, ns = shapeBase_;
+    size_t first = pushed_ - visible_.size();
+    coord_t dz = first * stageSectionLength;
+    vertices_.x.erase(vertices_.x.begin(), vertices_.x.begin() + nv);
+    vertices_.y.erase(vertices_.y.begin(), vertices_.y.begin() + nv);
+    vertices_.z.erase(vertices_.z.begin(), vertices_.z.begin() + nv);
+    for (coord_t& z : vertices_.z) z -= dz;
+    for (size_t i = 0; i < ns; ++i)
+        sparePoints_.push_back(std::move(shapes_[i].points));
+    shapes_.erase(shapes_.begin(), shapes_.begin() + ns);
+    for (ModelFragment& f : shapes_) {
+        f.start -= nv;
+        for (size_t& i : f.points) i -= nv;
+    }
+    vertexBase_ = shapeBase_ = 0;
+    pushed_ -= first;
+}
+
+void StageGeometry::render(SplinterBuffer& sbuf, Renderer3D& r3d,
+                           coord_t z) const {
+    size_t first = pushed_ - visible_.size();
+    r3d.renderGeometry(sbuf, Point3D(0, 0, z - first * stageSectionLength),
+                       vertices_, shapes_, vertexBase_, shapeBase_);
 }
 
 static MoveRegion parseMoveRegion(const std::string& s) {
@@ -174,8 +249,8 @@ static ObjectSpawn parseObject(const std::string& v, coord_t& dist, int lineNum,
     f *= stageSectionLength;
     z += front ? 0 : stageSpawnDistance;
     auto ptr = loadObjectSpawn(Point3D(x, y, z), name, prop);
-    return ObjectSpawn{
-        ptr, std::dynamic_pointer_cast<EnemyObject>(ptr) != nullptr, u, f};
+    bool isEnemy = dynamic_cast<EnemyObject*>(ptr.get()) != nullptr;
+    return ObjectSpawn{std::move(ptr), isEnemy, u, f};
 }
 
 static ObjectSpawn parseObjectZ(const std::string& v, coord_t& dist,
@@ -200,8 +275,8 @@ static ObjectSpawn parseObjectZ(const std::string& v, coord_t& dist,
     f *= stageSectionLength;
     z = stageSpawnDistance;
     auto ptr = loadObjectSpawn(Point3D(x, y, z), name, prop);
-    return ObjectSpawn{
-        ptr, std::dynamic_pointer_cast<EnemyObject>(ptr) != nullptr, u, f};
+    bool isEnemy = dynamic_cast<EnemyObject*>(ptr.get()) != nullptr;
+    return ObjectSpawn{std::move(ptr), isEnemy, u, f};
 }
 
 void GameStage::processSectionCommand(std::vector<section_t>& sections,
@@ -271,7 +346,8 @@ GameStage GameStage::load(int stagenum) {
                   return a.pos_i < b.pos_i ||
                          (a.pos_i == b.pos_i && a.pos_f < b.pos_f);
               });
-    std::deque<ObjectSpawn> realSpawns(spawns.begin(), spawns.end());
+    std::deque<ObjectSpawn> realSpawns(std::make_move_iterator(spawns.begin()),
+                                       std::make_move_iterator(spawns.end()));
     return GameStage(std::move(sections), loopLength, std::move(realSpawns));
 }
 
@@ -0,0 +1,72 @@
+/****************************************************************************/
+/*                                                                          */
+/*   HIEMALIA SOURCE CODE (C) 2021      SAMPO HIPPELAINEN (HISAHI).         */
+/*   SEE THE LICENSE FILE IN THE SOURCE ROOT DIRECTORY FOR LICENSE INFO.    */
+/*                                                                          */
+/****************************************************************************/
+// game/sweep.cc: implementation of the collision broadphase
+
+#include "game/sweep.hh"
+
+#include <algorithm>
+
+#include "game/world.hh"
+
+namespace hiemalia {
+
+// ranges longer than this go to wide_
+static const coord_t sweepWideLength = 1;
+// covers the rounding in collidesSphereSphere
+static const coord_t sweepSlack = 1.0 / 256;
+
+ObjectSweep::ObjectSweep() {
+    entries_.reserve(objectsMax);
+    reach_.reserve(objectsMax);
+    wide_.reserve(objectsMax);
+    hits_.reserve(objectsMax);
+}
+
+void ObjectSweep::clear() {
+    entries_.clear();
+    reach_.clear();
+    wide_.clear();
+    size_ = 0;
+}
+
+void ObjectSweep::insert(size_t index, coord_t z0, coord_t z1) {
+    Entry e{z0 - sweepSlack, z1 + sweepSlack, static_cast<uint32_t>(index)};
+    if (e.z1 - e.z0 > sweepWideLength)
+        wide_.push_back(e);
+    else
+        entries_.push_back(e);
+    size_ = index + 1;
+}
+
+void ObjectSweep::finish() {
+    std::sort(entries_.begin(), entries_.end(),
+              [](const Entry& a, const Entry& b) { return a.z0 < b.z0; });
+    coord_t reach = 0;
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        reach = i ? std::max(reach, entries_[i].z1) : entries_[i].z1;
+        reach_.push_back(reach);
+    }
+    valid_ = true;
+}
+
+void ObjectSweep::query(coord_t z0, coord_t z1, size_t n) {
+    hits_.clear();
+    // every entry before start ends before z0
+    size_t i = std::lower_bound(reach_.begin(), reach_.end(), z0) -
+               reach_.begin();
+    for (; i < entries_.size() && entries_[i].z0 <= z1; ++i) {
+        if (entries_[i].z1 >= z0) hits_.push_back(entries_[i].index);
+    }
+    for (const Entry& e : wide_) {
+        if (e.z0 <= z1 && e.z1 >= z0) hits_.push_back(e.index);
+    }
+    std::sort(hits_.begin(), hits_.end());
+    for (size_t j = size_; j < n; ++j)
+        hits_.push_back(static_cast<uint32_t>(j));
+}
+
+}  // namespace hiemalia
@@ -99,15 +99,20 @@ void GameWorld::resetStage(coord_t t) {
     moveSpeedBase = 0;
     moveSpeedDst = 1;
     objects.clear();
+    particles.clear();
+    playerExplosion = ParticleHandle{};
     enemies.clear();
     playerBullets.clear();
     enemyBullets.clear();
+    bulletSystem_.clear();
     if (t > 0) {
         moveForwardSkip(t);
         objects.clear();
+        particles.clear();
         enemies.clear();
         playerBullets.clear();
         enemyBullets.clear();
+        bulletSystem_.clear();
     }
     bossLevel = 0;
     bossSlideTime = 0;
@@ -171,6 +176,9 @@ void GameWorld::moveForwardSkip(coord_t dist) {
     }
 }
 
+// everything is moved back by a section whenever progress_f wraps, so all
+// positions stay within a few sections of the origin and rounding errors do
+// not grow with the length of the stage (even with float coordinates)
 void GameWorld::moveForward(coord_t dist) {
     if (!player) return;
     progress_f += dist;
@@ -181,9 +189,11 @@ void GameWorld::moveForward(coord_t dist) {
         if (bossLevel == 0) ++sections;
         player->move(0, 0, moveDist);
         for (auto& obj : objects) obj->move(0, 0, moveDist);
+        particles.move(Point3D(0, 0, moveDist));
         for (auto& obj : enemies) obj->move(0, 0, moveDist);
         for (auto& obj : playerBullets) obj->move(0, 0, moveDist);
         for (auto& obj : enemyBullets) obj->move(0, 0, moveDist);
+        bulletSystem_.move(Point3D(0, 0, moveDist));
         stage->nextSection();
     }
 
@@ -193,8 +203,8 @@ void GameWorld::moveForward(coord_t dist) {
         ObjectSpawn spawn{stage->spawnNext()};
         if (spawn.isEnemy)
             enemies
-                .emplace_back(std::dynamic_pointer_cast<EnemyObject>(
-                    std::move(spawn.obj)))
+                .emplace_back(
+                    poolPtrCast<EnemyObject>(std::move(spawn.obj)))
                 ->onSpawn(*this);
         else
             objects.emplace_back(std::move(spawn.obj))->onSpawn(*this);
@@ -226,8 +236,8 @@ bool GameWorld::runPlayer(float interval) {
     if (player)
         return player->tick(*this, interval);
     else if (playerExplosion) {
-        bool b = playerExplosion->tick(*this, interval);
-        if (!b) playerExplosion = nullptr;
+        bool b = particles.update(playerExplosion, interval);
+        if (!b) playerExplosion = ParticleHandle{};
         return b;
     } else
         return false;
@@ -244,7 +254,7 @@ void GameWorld::renderPlayer(SplinterBuffer& sbuf, Renderer3D& r3d,
         } else
             player->render(sbuf, r3d);
     } else if (playerExplosion)
-        playerExplosion->render(sbuf, r3d);
+        particles.render(playerExplosion, sbuf, r3d);
 }
 
 coord_t GameWorld::getMoveSpeed() const {
@@ -268,11 +278,11 @@ void GameWorld::updateMoveSpeedInput(const ControlState& inputs, float delta) {
     }
 }
 
-std::unique_ptr<PlayerObject>&& GameWorld::explodePlayer(
-    std::unique_ptr<Explosion>&& expl) {
-    playerExplosion = std::move(expl);
-    playerExplosion->adjustSpeed(sqrt(std::max(0.5, getMoveSpeed()) * 4));
-    dynamic_assert(playerExplosion != nullptr, "null explosion");
+std::unique_ptr<PlayerObject>&& GameWorld::explodePlayer(ParticleHandle expl) {
+    dynamic_assert(particles.alive(expl), "null explosion");
+    playerExplosion = expl;
+    particles.adjustSpeed(playerExplosion,
+                          sqrt(std::max<coord_t>(0.5, getMoveSpeed()) * 4));
     sendMessage(AudioMessage::stopMusic());
     sendMessage(AudioMessage::playSound(SoundEffect::PlayerExplode));
     return std::move(player);
@@ -281,34 +291,34 @@ std::unique_ptr<PlayerObject>&& GameWorld::explodePlayer(
 void GameWorld::onEnemyKilled(const GameObject& obj) { ++killed_; }
 
 void GameWorld::explodeEnemy(GameObject& obj, const Model& model) {
-    auto expl = std::make_shared<Explosion>(obj.pos, obj, 0.0, 0.0, 0.0, 2.0f);
-    expl->adjustSpeed(4.0);
-    objects.push_back(std::move(expl));
+    particles.adjustSpeed(particles.explode(obj.pos, obj, 0.0, 0.0, 0.0, 2.0f),
+                          4.0);
 }
 
 void GameWorld::explodeBoss(GameObject& obj, const Model& model) {
-    auto expl = std::make_shared<Explosion>(obj.pos, obj, 0.0, 0.0, 0.0, 0.5f);
-    expl->adjustSpeed(2.0);
-    objects.push_back(std::move(expl));
+    particles.adjustSpeed(particles.explode(obj.pos, obj, 0.0, 0.0, 0.0, 0.5f),
+                          2.0);
 }
 
 void GameWorld::explodeBullet(BulletObject& b) {
-    objects.push_back(
-        std::make_shared<Explosion>(b.pos, b, 0.0, 0.0, 0.0, 8.0f));
+    particles.explode(b.pos, b, 0.0, 0.0, 0.0, 8.0f);
 }
 
 const Point3D& GameWorld::getPlayerPosition() {
     if (player)
         return lastPos = player->pos;
     else if (playerExplosion)
-        return lastPos = playerExplosion->pos;
+        return lastPos = particles.position(playerExplosion);
     else
         return lastPos;
 }
 
+ParticleSystem& GameWorld::getParticles() { return particles; }
+
 bool GameWorld::respawn() {
     if (--lives < 0) return false;
-    playerExplosion = nullptr;
+    particles.free(playerExplosion);
+    playerExplosion = ParticleHandle{};
     resetStage(checkpoint);
     sendMessage(GameMessage::updateStatus());
     return true;
@@ -342,6 +352,7 @@ void GameWorld::endGame() {
     enemies.clear();
     playerBullets.clear();
     enemyBullets.clear();
+    bulletSystem_.clear();
     moveSpeedDst = 5;
     moveSpeedVel = 0.8;
     moveSpeedCtl = 0;
@@ -383,4 +394,24 @@ const BulletList& GameWorld::getPlayerBullets() const { return playerBullets; }
 
 const BulletList& GameWorld::getEnemyBullets() const { return enemyBullets; }
 
+BulletSystem& GameWorld::getBulletSystem() { return bulletSystem_; }
+
+void GameWorld::invalidateSweeps() {
+    enemySweep_.invalidate();
+    playerBulletSweep_.invalidate();
+    enemyBulletSweep_.invalidate();
+    bulletSystemSweep_.invalidate();
+}
+
+ObjectSweep& GameWorld::sweepOf(const EnemyList& list) {
+    dynamic_assert(&list == &enemies, "unknown object list");
+    return enemySweep_;
+}
+
+ObjectSweep& GameWorld::sweepOf(const BulletList& list) {
+    dynamic_assert(&list == &playerBullets || &list == &enemyBullets,
+                   "unknown object list");
+    return &list == &playerBullets ? playerBulletSweep_ : enemyBulletSweep_;
+}
+
 }  // namespace hiemalia
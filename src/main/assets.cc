@@ -30,6 +30,10 @@ const GameAssets& getAssets() {
         for (const auto& it : sectionMap)
             assets.sectionData[static_cast<int>(it.second)] =
                 std::make_shared<GameSection>(loadSection(it.first));
+        // all of them up front, so that the first object of a kind does not
+        // stop the game to read its model
+        for (int i = 0; i < static_cast<int>(GameModel::EndOfModels); ++i)
+            getGameModel(static_cast<GameModel>(i));
     }
     return assets;
 }
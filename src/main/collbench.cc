@@ -0,0 +1,530 @@
+/****************************************************************************/
+/*                                                                          */
+/*   HIEMALIA SOURCE CODE (C) 2021      SAMPO HIPPELAINEN (HISAHI).         */
+/*   SEE THE LICENSE FILE IN THE SOURCE ROOT DIRECTORY FOR LICENSE INFO.    */
+/*                                                                          */
+/****************************************************************************/
+// collbench.cc: benchmark and differential fuzzer for the collision kernels.
+// built as its own program (collbench) with only the collision code, see
+// the collide-bench target in src/Makefile
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <ostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "collide.hh"
+#include "random.hh"
+#include "str.hh"
+
+namespace hiemalia {
+
+static const size_t collideCases = 20000;
+// how many times the timing loop goes through all of the cases
+static const int collideRepeats = 20;
+// how many of the seeds that disagree are printed per kernel
+static const int collideListed = 3;
+// sweeps that pass closer than this to the shape or stop this close to the
+// reference are rounding, not disagreement
+static const long double collideTolerance =
+    std::cbrt(std::numeric_limits<coord_t>::epsilon());
+
+using ref_t = long double;
+
+struct RefPoint {
+    ref_t x, y, z;
+
+    RefPoint(ref_t x, ref_t y, ref_t z) : x(x), y(y), z(z) {}
+    RefPoint(const Point3D& p) : x(p.x), y(p.y), z(p.z) {}
+    RefPoint operator+(const RefPoint& p) const {
+        return RefPoint(x + p.x, y + p.y, z + p.z);
+    }
+    RefPoint operator-(const RefPoint& p) const {
+        return RefPoint(x - p.x, y - p.y, z - p.z);
+    }
+    RefPoint operator*(ref_t s) const { return RefPoint(x * s, y * s, z * s); }
+    ref_t dot(const RefPoint& p) const { return x * p.x + y * p.y + z * p.z; }
+    ref_t length() const { return std::sqrt(dot(*this)); }
+    RefPoint cross(const RefPoint& p) const {
+        return RefPoint(y * p.z - z * p.y, z * p.x - x * p.z,
+                        x * p.y - y * p.x);
+    }
+};
+
+// the reference versions below are written for clarity, not speed
+
+static RefPoint refClosestOnSegment(const RefPoint& p, const RefPoint& a,
+                                    const RefPoint& b) {
+    RefPoint ab = b - a;
+    ref_t aa = ab.dot(ab);
+    if (aa <= 0) return a;
+    return a + ab * std::clamp<ref_t>((p - a).dot(ab) / aa, 0, 1);
+}
+
+// p on the plane of the triangle
+static bool refInsideTri(const RefPoint& p, const RefPoint& a,
+                         const RefPoint& b, const RefPoint& c) {
+    RefPoint n = (b - a).cross(c - a);
+    return n.dot((b - a).cross(p - a)) >= 0 &&
+           n.dot((c - b).cross(p - b)) >= 0 &&
+           n.dot((a - c).cross(p - c)) >= 0;
+}
+
+static RefPoint refClosestOnTri(const RefPoint& p, const RefPoint& a,
+                                const RefPoint& b, const RefPoint& c) {
+    RefPoint n = (b - a).cross(c - a);
+    ref_t nn = n.dot(n);
+    if (nn > 0) {
+        RefPoint q = p - n * ((p - a).dot(n) / nn);
+        if (refInsideTri(q, a, b, c)) return q;
+    }
+    RefPoint best = refClosestOnSegment(p, a, b);
+    for (const RefPoint& q :
+         {refClosestOnSegment(p, b, c), refClosestOnSegment(p, c, a)})
+        if ((q - p).length() < (best - p).length()) best = q;
+    return best;
+}
+
+static ref_t refBoxDistance(const RefPoint& p, const RefPoint& a,
+                            const RefPoint& b) {
+    auto axis = [](ref_t x, ref_t lo, ref_t hi) {
+        if (lo > hi) std::swap(lo, hi);
+        return std::max<ref_t>({lo - x, x - hi, 0});
+    };
+    ref_t dx = axis(p.x, a.x, b.x);
+    ref_t dy = axis(p.y, a.y, b.y);
+    ref_t dz = axis(p.z, a.z, b.z);
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+static ref_t refShapeDistance(const RefPoint& p, const CollisionShape& shape) {
+    switch (shape.type) {
+        case CollisionShapeType::Point:
+            return (p - shape.p).length();
+        case CollisionShapeType::Line:
+            return (p - refClosestOnSegment(p, shape.p, shape.p1)).length();
+        case CollisionShapeType::Cuboid:
+            return refBoxDistance(p, shape.p, shape.p1);
+        case CollisionShapeType::Sphere:
+            return (p - shape.p).length() - shape.r;
+        case CollisionShapeType::Tri:
+            return (p - refClosestOnTri(p, shape.p, shape.p1, shape.p2))
+                .length();
+        default:
+            never("invalid shape");
+    }
+}
+
+static bool refSegmentBox(const RefPoint& a, const RefPoint& b,
+                          const RefPoint& q1, const RefPoint& q2) {
+    ref_t t0 = 0, t1 = 1;
+    auto slab = [&](ref_t c, ref_t d, ref_t lo, ref_t hi) {
+        if (lo > hi) std::swap(lo, hi);
+        if (d == 0) return lo <= c && c <= hi;
+        ref_t ta = (lo - c) / d, tb = (hi - c) / d;
+        if (ta > tb) std::swap(ta, tb);
+        t0 = std::max(t0, ta);
+        t1 = std::min(t1, tb);
+        return t0 <= t1;
+    };
+    RefPoint d = b - a;
+    return slab(a.x, d.x, q1.x, q2.x) && slab(a.y, d.y, q1.y, q2.y) &&
+           slab(a.z, d.z, q1.z, q2.z);
+}
+
+// segments lying on the plane of the triangle never cross it
+static bool refSegmentTri(const RefPoint& a, const RefPoint& b,
+                          const RefPoint& t1, const RefPoint& t2,
+                          const RefPoint& t3) {
+    RefPoint n = (t2 - t1).cross(t3 - t1);
+    ref_t sa = n.dot(a - t1), sb = n.dot(b - t1);
+    if ((sa > 0 && sb > 0) || (sa < 0 && sb < 0) || sa == sb) return false;
+    return refInsideTri(a + (b - a) * (sa / (sa - sb)), t1, t2, t3);
+}
+
+// separating axis test
+static bool refBoxTri(const RefPoint& q1, const RefPoint& q2,
+                      const RefPoint& t1, const RefPoint& t2,
+                      const RefPoint& t3) {
+    RefPoint c = (q1 + q2) * 0.5;
+    RefPoint h(std::abs(q2.x - q1.x) / 2, std::abs(q2.y - q1.y) / 2,
+               std::abs(q2.z - q1.z) / 2);
+    RefPoint v[] = {t1 - c, t2 - c, t3 - c};
+    RefPoint e[] = {v[1] - v[0], v[2] - v[1], v[0] - v[2]};
+    RefPoint axes[] = {RefPoint(1, 0, 0), RefPoint(0, 1, 0),
+                       RefPoint(0, 0, 1)};
+    auto separates = [&](const RefPoint& ax) {
+        ref_t p0 = ax.dot(v[0]), p1 = ax.dot(v[1]), p2 = ax.dot(v[2]);
+        ref_t r = h.x * std::abs(ax.x) + h.y * std::abs(ax.y) +
+                  h.z * std::abs(ax.z);
+        return std::min({p0, p1, p2}) > r || std::max({p0, p1, p2}) < -r;
+    };
+    if (separates(e[0].cross(e[1]))) return false;
+    for (const RefPoint& a : axes) {
+        if (separates(a)) return false;
+        for (const RefPoint& x : e)
+            if (separates(x.cross(a))) return false;
+    }
+    return true;
+}
+
+// the sweep goes from p[0] to p[1] with radius r1; shapes use p[2] onwards.
+// the cuboids have their corners in order like those of models: q[0] and
+// q[1] span p[2] and p[3], q[2] and q[3] span p[0] and p[1]
+struct CollideCase {
+    std::vector<Point3D> p;
+    std::vector<Point3D> q;
+    coord_t r1;
+    coord_t r2;
+};
+
+static CollideCase makeCollideCase(uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<coord_t> u(-1, 1);
+    CollideCase c;
+    for (int i = 0; i < 6; ++i) {
+        // one by one, since the order of arguments is unspecified
+        coord_t x = u(rng), y = u(rng), z = u(rng);
+        c.p.emplace_back(x, y, z);
+    }
+    for (int i : {2, 0}) {
+        const Point3D& a = c.p[i];
+        const Point3D& b = c.p[i + 1];
+        c.q.emplace_back(std::min(a.x, b.x), std::min(a.y, b.y),
+                         std::min(a.z, b.z));
+        c.q.emplace_back(std::max(a.x, b.x), std::max(a.y, b.y),
+                         std::max(a.z, b.z));
+    }
+    c.r1 = (u(rng) + 1) * 0.25;
+    c.r2 = (u(rng) + 1) * 0.25;
+    return c;
+}
+
+struct CollideKernel {
+    const char* name;
+    bool (*test)(const CollideCase& c);
+    bool (*reference)(const CollideCase& c);
+};
+
+static const CollideKernel collideKernels[] = {
+    {"point-sphere",
+     [](const CollideCase& c) {
+         return collidesPointSphere(c.p[0], c.p[1], c.r1);
+     },
+     [](const CollideCase& c) {
+         return (RefPoint(c.p[0]) - c.p[1]).length() <= c.r1;
+     }},
+    {"line-sphere",
+     [](const CollideCase& c) {
+         return collidesLineSphere(c.p[0], c.p[1], c.p[2], c.r1);
+     },
+     [](const CollideCase& c) {
+         RefPoint p = c.p[2];
+         return (refClosestOnSegment(p, c.p[0], c.p[1]) - p).length() <= c.r1;
+     }},
+    {"point-cuboid",
+     [](const CollideCase& c) {
+         return collidesPointCuboid(c.p[0], c.q[0], c.q[1]);
+     },
+     [](const CollideCase& c) {
+         return refBoxDistance(c.p[0], c.q[0], c.q[1]) <= 0;
+     }},
+    {"line-cuboid",
+     [](const CollideCase& c) {
+         return collidesLineCuboid(c.p[0], c.p[1], c.q[0], c.q[1]);
+     },
+     [](const CollideCase& c) {
+         return refSegmentBox(c.p[0], c.p[1], c.q[0], c.q[1]);
+     }},
+    {"sphere-cuboid",
+     [](const CollideCase& c) {
+         return collidesSphereCuboid(c.p[0], c.r1, c.q[0], c.q[1]);
+     },
+     [](const CollideCase& c) {
+         return refBoxDistance(c.p[0], c.q[0], c.q[1]) <= c.r1;
+     }},
+    {"cuboid-cuboid",
+     [](const CollideCase& c) {
+         return collidesCuboidCuboid(c.q[2], c.q[3], c.q[0], c.q[1]);
+     },
+     [](const CollideCase& c) {
+         const auto& q = c.q;
+         return q[2].x <= q[1].x && q[0].x <= q[3].x && q[2].y <= q[1].y &&
+                q[0].y <= q[3].y && q[2].z <= q[1].z && q[0].z <= q[3].z;
+     }},
+    {"sphere-sphere",
+     [](const CollideCase& c) {
+         return collidesSphereSphere(c.p[0], c.r1, c.p[1], c.r2);
+     },
+     [](const CollideCase& c) {
+         return (RefPoint(c.p[0]) - c.p[1]).length() <= ref_t(c.r1) + c.r2;
+     }},
+    {"line-tri",
+     [](const CollideCase& c) {
+         return collidesLineTri(c.p[0], c.p[1], c.p[2], c.p[3], c.p[4]);
+     },
+     [](const CollideCase& c) {
+         return refSegmentTri(c.p[0], c.p[1], c.p[2], c.p[3], c.p[4]);
+     }},
+    {"cuboid-tri",
+     [](const CollideCase& c) {
+         return collidesCuboidTri(c.q[2], c.q[3], c.p[2], c.p[3], c.p[4]);
+     },
+     [](const CollideCase& c) {
+         return refBoxTri(c.q[2], c.q[3], c.p[2], c.p[3], c.p[4]);
+     }},
+    {"sphere-tri",
+     [](const CollideCase& c) {
+         return collidesSphereTri(c.p[0], c.r1, c.p[2], c.p[3], c.p[4]);
+     },
+     [](const CollideCase& c) {
+         RefPoint p = c.p[0];
+         return (refClosestOnTri(p, c.p[2], c.p[3], c.p[4]) - p).length() <=
+                c.r1;
+     }},
+    {"tri-tri",
+     [](const CollideCase& c) {
+         return collidesTriTri(c.p[0], c.p[1], c.p[2], c.p[3], c.p[4],
+                               c.p[5]);
+     },
+     [](const CollideCase& c) {
+         // unless they are on the same plane, one triangle has an edge
+         // through the other one
+         const auto& p = c.p;
+         return refSegmentTri(p[0], p[1], p[3], p[4], p[5]) ||
+                refSegmentTri(p[1], p[2], p[3], p[4], p[5]) ||
+                refSegmentTri(p[2], p[0], p[3], p[4], p[5]) ||
+                refSegmentTri(p[3], p[4], p[0], p[1], p[2]) ||
+                refSegmentTri(p[4], p[5], p[0], p[1], p[2]) ||
+                refSegmentTri(p[5], p[3], p[0], p[1], p[2]);
+     }},
+};
+
+struct SweepKernel {
+    const char* name;
+    CollisionShape (*shape)(const CollideCase& c);
+};
+
+static const SweepKernel sweepKernels[] = {
+    {"point",
+     [](const CollideCase& c) { return CollisionShape::point(c.p[2]); }},
+    {"line",
+     [](const CollideCase& c) { return CollisionShape::line(c.p[2], c.p[3]); }},
+    {"cuboid",
+     [](const CollideCase& c) {
+         return CollisionShape::cuboid(c.q[0], c.q[1]);
+     }},
+    {"sphere",
+     [](const CollideCase& c) { return CollisionShape::sphere(c.p[2], c.r2); }},
+    {"tri",
+     [](const CollideCase& c) {
+         return CollisionShape::tri(c.p[2], c.p[3], c.p[4]);
+     }},
+};
+
+// the first t at which the sweep is within r1 of the shape, or -1 if it
+// never is. closest is how near it gets. the distance is convex along the
+// sweep, so its minimum is found by ternary search and the first contact by
+// bisection before that
+static ref_t refImpact(const CollideCase& c, const CollisionShape& shape,
+                       ref_t& closest) {
+    RefPoint a = c.p[0];
+    RefPoint d = RefPoint(c.p[1]) - a;
+    auto f = [&](ref_t t) {
+        return refShapeDistance(a + d * t, shape) - c.r1;
+    };
+    ref_t lo = 0, hi = 1;
+    for (int i = 0; i < 100; ++i) {
+        ref_t m1 = lo + (hi - lo) / 3, m2 = hi - (hi - lo) / 3;
+        if (f(m1) < f(m2))
+            hi = m2;
+        else
+            lo = m1;
+    }
+    ref_t tm = (lo + hi) / 2;
+    closest = f(tm);
+    if (closest > 0) return -1;
+    if (f(0) <= 0) return 0;
+    lo = 0, hi = tm;
+    for (int i = 0; i < 100; ++i) {
+        ref_t m = (lo + hi) / 2;
+        (f(m) <= 0 ? hi : lo) = m;
+    }
+    return hi;
+}
+
+static volatile size_t collideSink;
+
+// the calls go through a function pointer or a lambda like the ones above,
+// so a few ns of every result are call overhead
+template <typename F>
+static double nsPerCall(size_t n, F&& f) {
+    size_t hits = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < collideRepeats; ++rep)
+        for (size_t i = 0; i < n; ++i) hits += f(i);
+    auto t1 = std::chrono::steady_clock::now();
+    collideSink = hits;
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() /
+           (static_cast<double>(n) * collideRepeats);
+}
+
+// one row of the report, with the first few seeds that disagreed
+struct CollideRow {
+    std::string name;
+    double ns{0};
+    size_t hits{0};
+    size_t disagree{0};
+    std::vector<uint32_t> seeds;
+
+    explicit CollideRow(std::string name) : name(std::move(name)) {}
+
+    void fail(uint32_t seed) {
+        if (disagree++ < collideListed) seeds.push_back(seed);
+    }
+    void print(std::ostream& out, size_t n) const {
+        out << stringFormat("  %-16s %9.1f %7.2f%% %8zu %7.3f%%\n",
+                            name.c_str(), ns, hits * 100.0 / n, disagree,
+                            disagree * 100.0 / n);
+        for (uint32_t seed : seeds)
+            out << stringFormat("      disagrees on seed %u\n", seed);
+    }
+};
+
+// times every collision kernel on random cases and compares its results
+// with a slow long double reference. prints the seed of every case that
+// disagrees
+static void benchCollide(std::ostream& out) {
+    std::vector<uint32_t> seeds;
+    std::vector<CollideCase> cases;
+    for (size_t i = 0; i < collideCases; ++i) {
+        seeds.push_back(random(std::uniform_int_distribution<uint32_t>()));
+        cases.push_back(makeCollideCase(seeds.back()));
+    }
+    size_t n = cases.size();
+    out << stringFormat(
+        "collide: %zu cases per kernel, tolerance %g; rerun a case with "
+        "collbench <seed>\n",
+        n, static_cast<double>(collideTolerance));
+    out << stringFormat("  %-16s %9s %8s %8s %8s\n", "kernel", "ns/call",
+                        "hits", "disagree", "rate");
+
+    for (const CollideKernel& k : collideKernels) {
+        CollideRow row(k.name);
+        for (size_t i = 0; i < n; ++i) {
+            bool hit = k.test(cases[i]);
+            row.hits += hit;
+            if (hit != k.reference(cases[i])) row.fail(seeds[i]);
+        }
+        row.ns = nsPerCall(n, [&](size_t i) { return k.test(cases[i]); });
+        row.print(out, n);
+    }
+
+    for (const SweepKernel& k : sweepKernels) {
+        std::vector<ModelCollision> models;
+        for (const CollideCase& c : cases)
+            models.emplace_back(std::vector<CollisionShape>{k.shape(c)});
+        CollideRow sweep(std::string("sweep-") + k.name);
+        CollideRow impact(std::string("impact-") + k.name);
+        for (size_t i = 0; i < n; ++i) {
+            const CollideCase& c = cases[i];
+            const CollisionShape& shape = models[i].shapes[0];
+            bool hit = collidesSweepSphereModel(c.p[0], c.p[1], c.r1,
+                                                models[i]);
+            sweep.hits += hit;
+            ref_t closest;
+            ref_t t = refImpact(c, shape, closest);
+            if (hit != (t >= 0) && std::abs(closest) > collideTolerance)
+                sweep.fail(seeds[i]);
+
+            SweepImpact im =
+                collidesSweepSphereShapeImpact(c.p[0], c.p[1], c.r1, shape);
+            impact.hits += im.hit;
+            bool wrong = im.hit != (t >= 0)
+                             ? std::abs(closest) > collideTolerance
+                             : im.hit && std::abs(im.t - t) > collideTolerance;
+            if (wrong) impact.fail(seeds[i]);
+        }
+        sweep.ns = nsPerCall(n, [&](size_t i) {
+            const CollideCase& c = cases[i];
+            return collidesSweepSphereModel(c.p[0], c.p[1], c.r1, models[i]);
+        });
+        impact.ns = nsPerCall(n, [&](size_t i) {
+            const CollideCase& c = cases[i];
+            return collidesSweepSphereShapeImpact(c.p[0], c.p[1], c.r1,
+                                                  models[i].shapes[0])
+                .hit;
+        });
+        sweep.print(out, n);
+        impact.print(out, n);
+    }
+}
+
+// runs every kernel on the case made from seed and prints the results next
+// to the reference
+static void benchCollideCase(std::ostream& out, uint32_t seed) {
+    CollideCase c = makeCollideCase(seed);
+    out << stringFormat("collide: case %u\n", seed);
+    for (size_t i = 0; i < c.p.size(); ++i)
+        out << stringFormat("  p[%zu] = %.9g %.9g %.9g\n", i,
+                            static_cast<double>(c.p[i].x),
+                            static_cast<double>(c.p[i].y),
+                            static_cast<double>(c.p[i].z));
+    out << stringFormat("  r1 = %.9g, r2 = %.9g\n", static_cast<double>(c.r1),
+                        static_cast<double>(c.r2));
+    for (const CollideKernel& k : collideKernels)
+        out << stringFormat("  %-16s kernel %d reference %d\n", k.name,
+                            k.test(c), k.reference(c));
+    for (const SweepKernel& k : sweepKernels) {
+        ModelCollision model(std::vector<CollisionShape>{k.shape(c)});
+        const CollisionShape& shape = model.shapes[0];
+        ref_t closest;
+        ref_t t = refImpact(c, shape, closest);
+        out << stringFormat(
+            "  sweep-%-10s kernel %d reference %d (closest %.9g)\n", k.name,
+            collidesSweepSphereModel(c.p[0], c.p[1], c.r1, model), t >= 0,
+            static_cast<double>(closest));
+        SweepImpact im =
+            collidesSweepSphereShapeImpact(c.p[0], c.p[1], c.r1, shape);
+        out << stringFormat(
+            "  impact-%-9s kernel %d t %.9g reference %d t %.9g\n", k.name,
+            im.hit, static_cast<double>(im.t), t >= 0,
+            static_cast<double>(t));
+    }
+}
+
+// the game has these in hiemalia.cc
+void never_(const std::string& file, unsigned line, const std::string& msg) {
+    std::cerr << "never (" << file << ":" << line << "): " << msg
+              << std::endl;
+    std::abort();
+}
+
+void dynamic_assert_(const std::string& file, unsigned line, bool condition,
+                     const std::string& msg) {
+    if (condition) return;
+    std::cerr << "assertion failure (" << file << ":" << line << "): " << msg
+              << std::endl;
+    std::abort();
+}
+
+}  // namespace hiemalia
+
+// collbench runs the whole benchmark, collbench <seed> reruns one case
+int main(int argc, char* argv[]) {
+    hiemalia::seedRandomEngine(0);
+    if (argc > 1)
+        hiemalia::benchCollideCase(
+            std::cout, hiemalia::fromString<uint32_t>(argv[1]));
+    else
+        hiemalia::benchCollide(std::cout);
+    return EXIT_SUCCESS;
+}
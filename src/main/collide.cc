@@ -10,14 +10,24 @@
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <tuple>
 
 #include "logger.hh"
 #include "math.hh"
+#include "stats.hh"
 
 namespace hiemalia {
 // sensitivity
 static const coord_t pointRadius = 1.0 / 1024;
+// the 3x3 inverse in pointRemapPlane is done in double even if coord_t is
+// float: the determinant of a small or thin triangle loses most of its
+// significant digits to cancellation
+using remap_t = double;
+// distances from a plane closer than this are rounding noise (with float
+// coordinates, a point on a triangle's plane can be off by a few ulps)
+static const coord_t planeEpsilon =
+    std::numeric_limits<coord_t>::epsilon() * 16;
 /*
 static inline coord_t distanceSquared(const Point3D& p1, const Point3D& p2) {
     return (p1 - p2).lengthSquared();
@@ -109,42 +119,28 @@ static bool collides2DLineLine(coord_t ax1, coord_t ay1, coord_t ax2,
     return 0 <= n && n <= 1 && 0 <= m && m <= 1;
 }
 
-static coord_t collides2DLineLineWhereUnlerp(coord_t ax1, coord_t ay1,
-                                             coord_t ax2, coord_t ay2,
-                                             coord_t bx1, coord_t by1,
-                                             coord_t bx2, coord_t by2) {
-    coord_t d = (ax2 - ax1) * (by2 - by1) - (ay2 - ay1) * (bx2 - bx1);
-    if (d == 0) {
-        ax2 -= ax1, bx1 -= ax1, bx2 -= ax1;
-        ay2 -= ay1, by1 -= ay1, by2 -= ay1;
-        d = 1.0 / (ax2 * ax2 + ay2 * ay2);
-        coord_t a = d * (ax2 * bx1 + ay2 * by1);
-        coord_t b = d * (ax2 * bx2 + ay2 * by2);
-        return std::min(unlerp<coord_t>(a, 0, b), unlerp<coord_t>(a, 1, b));
-    }
-
-    return ((ay1 - by1) * (ax2 - ax1) - (ax1 - bx1) * (ay2 - ay1)) / d;
-}
-
 std::tuple<coord_t, coord_t, coord_t> pointRemapPlane(Point3D tx, Point3D ty,
                                                       Point3D tz, Point3D p) {
+    remap_t xx = tx.x, xy = tx.y, xz = tx.z;
+    remap_t yx = ty.x, yy = ty.y, yz = ty.z;
+    remap_t zx = tz.x, zy = tz.y, zz = tz.z;
     // compute partial inverse matrix
-    coord_t idet = 1.0 / (tx.x * (ty.y * tz.z - tz.y * ty.z) -
-                          ty.x * (tx.y * tz.z - tz.y * tx.z) +
-                          tz.x * (tx.y * ty.z - ty.y * tx.z));
-    coord_t ixx = idet * (ty.y * tz.z - tz.y * ty.z);
-    coord_t iyx = idet * (tz.x * ty.z - ty.x * tz.z);
-    coord_t izx = idet * (ty.x * tz.y - tz.x * ty.y);
-    coord_t ixy = idet * (tz.y * tx.z - tx.y * tz.z);
-    coord_t iyy = idet * (tx.x * tz.z - tz.x * tx.z);
-    coord_t izy = idet * (tz.x * tx.y - tx.x * tz.y);
-
-    coord_t ixz = idet * (tx.y * ty.z - ty.y * tx.z);
-    coord_t iyz = idet * (ty.x * tx.z - tx.x * ty.z);
-    coord_t izz = idet * (tx.x * ty.y - ty.x * tx.y);
-    return std::make_tuple(p.x * ixx + p.y * iyx + p.z * izx,
-                           p.x * ixy + p.y * iyy + p.z * izy,
-                           p.x * ixz + p.y * iyz + p.z * izz);
+    remap_t idet = 1.0 / (xx * (yy * zz - zy * yz) - yx * (xy * zz - zy * xz) +
+                          zx * (xy * yz - yy * xz));
+    remap_t ixx = idet * (yy * zz - zy * yz);
+    remap_t iyx = idet * (zx * yz - yx * zz);
+    remap_t izx = idet * (yx * zy - zx * yy);
+    remap_t ixy = idet * (zy * xz - xy * zz);
+    remap_t iyy = idet * (xx * zz - zx * xz);
+    remap_t izy = idet * (zx * xy - xx * zy);
+
+    remap_t ixz = idet * (xy * yz - yy * xz);
+    remap_t iyz = idet * (yx * xz - xx * yz);
+    remap_t izz = idet * (xx * yy - yx * xy);
+    remap_t px = p.x, py = p.y, pz = p.z;
+    return std::tuple<coord_t, coord_t, coord_t>(
+        px * ixx + py * iyx + pz * izx, px * ixy + py * iyy + pz * izy,
+        px * ixz + py * iyz + pz * izz);
 }
 
 static coord_t closestDistanceToTriFromPoint(const Point3D& t1,
@@ -301,6 +297,12 @@ bool collidesSphereLine(const Point3D& center, coord_t radius,
     return collidesLineSphere(line1, line2, center, radius);
 }
 
+// which side of a plane a point at (signed) distance d is on; 0 if it is
+// within planeEpsilon of the plane
+static inline int planeSide(coord_t d) {
+    return d > planeEpsilon ? 1 : d < -planeEpsilon ? -1 : 0;
+}
+
 bool collidesTriTri(const Point3D& ta1, const Point3D& ta2, const Point3D& ta3,
                     const Point3D& tb1, const Point3D& tb2,
                     const Point3D& tb3) {
@@ -311,10 +313,9 @@ bool collidesTriTri(const Point3D& ta1, const Point3D& ta2, const Point3D& ta3,
     Point3D b3 = tb3 - ta3;
     Point3D n = a1.cross(a2).normalize();
     coord_t b1d = n.dot(b1), b2d = n.dot(b2), b3d = n.dot(b3);
+    int b1s = planeSide(b1d), b2s = planeSide(b2d), b3s = planeSide(b3d);
 
-    if (sgn(b1d) != 0 && sgn(b1d) == sgn(b2d) && sgn(b1d) == sgn(b3d) &&
-        sgn(b2d) == sgn(b3d))
-        return false;
+    if (b1s != 0 && b1s == b2s && b1s == b3s && b2s == b3s) return false;
 
     if (abs(b1d) < pointRadius &&
         collidesSphereTri(tb1, pointRadius, ta1, ta2, ta3))
@@ -379,331 +380,699 @@ static bool collidesSweepSphereTri(const Point3D& c1, const Point3D& c2,
            collidesTriTri(c1 + td, c2, c2 + td, t1, t2, t3);
 }
 
-static Point3D collidesSweepSpherePointWhere(const Point3D& l1,
-                                             const Point3D& l2, coord_t r,
-                                             const Point3D& p) {
-    return p;
+// the impact kernels below keep the earliest impact in best. d is the whole
+// motion of the sweep (c2 - c1); t is a fraction of it
+
+static void keepEarliest(SweepImpact& best, coord_t t, const Point3D& contact) {
+    if (best.hit && best.t <= t) return;
+    best.hit = true;
+    best.t = t;
+    best.contact = contact;
+}
+
+// the first t in [0, 1] at which |m + d * t| <= r
+static bool firstWithin(const Point3D& m, const Point3D& d, coord_t r,
+                        coord_t& t) {
+    coord_t c = pointDot(m, m) - r * r;
+    if (c <= 0) {
+        t = 0;
+        return true;
+    }
+    coord_t a = pointDot(d, d);
+    coord_t b = pointDot(m, d);
+    if (a <= 0 || b >= 0) return false;
+    coord_t disc = b * b - a * c;
+    if (disc < 0) return false;
+    t = (-b - std::sqrt(disc)) / a;
+    return t <= 1;
+}
+
+// also takes points (sr = 0)
+static void impactSweepSphereSphere(SweepImpact& best, const Point3D& c1,
+                                    const Point3D& d, coord_t r,
+                                    const Point3D& sc, coord_t sr) {
+    coord_t t;
+    if (!firstWithin(c1 - sc, d, r + sr, t)) return;
+    Point3D c = c1 + d * t;
+    keepEarliest(best, t, sr > 0 ? sc + (c - sc) * (sr / (r + sr)) : sc);
 }
 
-static Point3D collidesSweepSphereLineWhere(const Point3D& l1,
-                                            const Point3D& l2, coord_t r,
-                                            const Point3D& a1,
-                                            const Point3D& a2) {
-    return closestPointOnLineToLine(l1, l2, a1, a2);
+static void impactSweepSphereLine(SweepImpact& best, const Point3D& c1,
+                                  const Point3D& d, coord_t r,
+                                  const Point3D& l1, const Point3D& l2) {
+    impactSweepSphereSphere(best, c1, d, r, l1, 0);
+    impactSweepSphereSphere(best, c1, d, r, l2, 0);
+    Point3D ax = l2 - l1;
+    coord_t aa = pointDot(ax, ax);
+    if (aa <= 0) return;
+    // the side of the capsule: the same without the motion along the line
+    Point3D m = c1 - l1;
+    Point3D mp = m - ax * (pointDot(m, ax) / aa);
+    Point3D dp = d - ax * (pointDot(d, ax) / aa);
+    coord_t t;
+    if (!firstWithin(mp, dp, r, t)) return;
+    coord_t s = pointDot(m + d * t, ax) / aa;
+    if (0 <= s && s <= 1) keepEarliest(best, t, l1 + ax * s);
 }
 
-Point3D collidesSweepSphereSphereWhere(const Point3D& l1, const Point3D& l2,
-                                       coord_t r, const Point3D& sc,
-                                       coord_t sr) {
-    coord_t a = pointDot(l2, l2);
-    coord_t b = 2 * pointDot(l2, l1 - sc);
-    coord_t c = pointDot(l1 - sc, l1 - sc) - sr * sr;
-    coord_t d = b * b - 4 * a * c;
-    if (d < 0) {
-        LOG_WARN("tried to find intersection point, but there is none");
-        return l1;
+// the box grown by r with rounded edges and corners. the slab test finds
+// where the sphere enters the box grown by r; that is exact on the faces,
+// but where the entry is outside the box on two or three axes, the sphere
+// has to touch one of the edges (or their end points) of that region
+static void impactSweepSphereCuboid(SweepImpact& best, const Point3D& c1,
+                                    const Point3D& d, coord_t r,
+                                    const Point3D& q1, const Point3D& q2) {
+    Point3D lo(std::min(q1.x, q2.x), std::min(q1.y, q2.y),
+               std::min(q1.z, q2.z));
+    Point3D hi(std::max(q1.x, q2.x), std::max(q1.y, q2.y),
+               std::max(q1.z, q2.z));
+    coord_t t0 = 0, t1 = 1;
+    auto slab = [&](coord_t c, coord_t v, coord_t a, coord_t b) {
+        a -= r, b += r;
+        if (v == 0) return a <= c && c <= b;
+        coord_t ta = (a - c) / v, tb = (b - c) / v;
+        if (ta > tb) std::swap(ta, tb);
+        t0 = std::max(t0, ta);
+        t1 = std::min(t1, tb);
+        return t0 <= t1;
+    };
+    if (!slab(c1.x, d.x, lo.x, hi.x) || !slab(c1.y, d.y, lo.y, hi.y) ||
+        !slab(c1.z, d.z, lo.z, hi.z))
+        return;
+    Point3D c = c1 + d * t0;
+    bool ox = c.x < lo.x || c.x > hi.x;
+    bool oy = c.y < lo.y || c.y > hi.y;
+    bool oz = c.z < lo.z || c.z > hi.z;
+    int outside = ox + oy + oz;
+    if (outside < 2) {
+        keepEarliest(best, t0,
+                     Point3D(clamp(lo.x, c.x, hi.x), clamp(lo.y, c.y, hi.y),
+                             clamp(lo.z, c.z, hi.z)));
+        return;
     }
-    coord_t q = 0.5 / a;
-    d = sqrt(d);
-    return Point3D::lerp(l1, std::min(q * (-b + d), q * (-b - d)), l2);
+    // an edge region has the edge along the axis c is inside on; a corner
+    // region has the three edges that meet at the corner
+    coord_t kx = c.x < lo.x ? lo.x : hi.x;
+    coord_t ky = c.y < lo.y ? lo.y : hi.y;
+    coord_t kz = c.z < lo.z ? lo.z : hi.z;
+    if (outside == 3 || !ox)
+        impactSweepSphereLine(best, c1, d, r, Point3D(lo.x, ky, kz),
+                              Point3D(hi.x, ky, kz));
+    if (outside == 3 || !oy)
+        impactSweepSphereLine(best, c1, d, r, Point3D(kx, lo.y, kz),
+                              Point3D(kx, hi.y, kz));
+    if (outside == 3 || !oz)
+        impactSweepSphereLine(best, c1, d, r, Point3D(kx, ky, lo.z),
+                              Point3D(kx, ky, hi.z));
 }
 
-static coord_t validateCuboidUnlerp(coord_t x) { return x < 0 ? 1 : x; }
+// p on the plane of the triangle t1, t1 + e1, t1 + e2
+static bool insideTri(const Point3D& p, const Point3D& t1, const Point3D& e1,
+                      const Point3D& e2) {
+    Point3D v = p - t1;
+    coord_t d11 = pointDot(e1, e1), d12 = pointDot(e1, e2);
+    coord_t d22 = pointDot(e2, e2);
+    coord_t v1 = pointDot(v, e1), v2 = pointDot(v, e2);
+    coord_t den = d11 * d22 - d12 * d12;
+    if (den <= 0) return false;
+    coord_t a = (d22 * v1 - d12 * v2) / den;
+    coord_t b = (d11 * v2 - d12 * v1) / den;
+    return a >= 0 && b >= 0 && a + b <= 1;
+}
 
-Point3D collidesSweepSphereCuboidWhere(const Point3D& l1, const Point3D& l2,
-                                       coord_t r, const Point3D& c1,
-                                       const Point3D& c2) {
-    coord_t tx = validateCuboidUnlerp(l2.x > l1.x ? unlerp(l1.x, c1.x, l2.x)
-                                                  : unlerp(l1.x, c2.x, l2.x));
-    coord_t ty = validateCuboidUnlerp(l2.y > l1.y ? unlerp(l1.y, c1.y, l2.y)
-                                                  : unlerp(l1.y, c2.y, l2.y));
-    coord_t tz = validateCuboidUnlerp(l2.z > l1.z ? unlerp(l1.z, c1.z, l2.z)
-                                                  : unlerp(l1.z, c2.z, l2.z));
-    return Point3D::lerp(l1, std::min({tx, ty, tz}), l2);
+static void impactSweepSphereTri(SweepImpact& best, const Point3D& c1,
+                                 const Point3D& d, coord_t r,
+                                 const Point3D& t1, const Point3D& t2,
+                                 const Point3D& t3) {
+    Point3D e1 = t2 - t1;
+    Point3D e2 = t3 - t1;
+    // not pointCross, which flips y
+    Point3D n(e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z,
+              e1.x * e2.y - e1.y * e2.x);
+    coord_t nl = n.length();
+    if (nl > 0) {
+        n = n * (1 / nl);
+        coord_t s0 = pointDot(n, c1 - t1);
+        coord_t sd = pointDot(n, d);
+        // when the sphere first touches the plane
+        coord_t t = -1;
+        if (std::abs(s0) <= r)
+            t = 0;
+        else if (s0 * sd < 0)
+            t = (s0 - std::copysign(r, s0)) / -sd;
+        if (0 <= t && t <= 1) {
+            Point3D c = c1 + d * t;
+            Point3D p = c - n * pointDot(n, c - t1);
+            if (insideTri(p, t1, e1, e2)) {
+                // nothing else on the triangle can be touched earlier
+                keepEarliest(best, t, p);
+                return;
+            }
+        }
+    }
+    impactSweepSphereLine(best, c1, d, r, t1, t2);
+    impactSweepSphereLine(best, c1, d, r, t2, t3);
+    impactSweepSphereLine(best, c1, d, r, t3, t1);
 }
 
-static Point3D collidesSweepSphereTriWhere(const Point3D& c1, const Point3D& c2,
-                                           coord_t r, const Point3D& t1,
-                                           const Point3D& t2,
-                                           const Point3D& t3) {
-    Point3D tx = (t1 + t2 + t3) * (1.0 / 3);
-    Point3D cx = Point3D::average(c1, c2);
-    Point3D cd = c2 - c1;
-    Point3D td = tx - cx;
-    td -= cd * pointProj(td, cd);
-    if (td.length() > r) td = td.normalize() * r;
-    if (collidesSphereTri(c1, r, t1, t2, t3) &&
-        !collidesSphereTri(c1, pointRadius, t1, t2, t3))
-        return c1;
-    if (collidesSphereTri(c2, r, t1, t2, t3) &&
-        !collidesSphereTri(c2, pointRadius, t1, t2, t3))
-        return c2;
-
-    Point3D a = c1 - t1;
-    Point3D b = c2 - t1;
-    Point3D x = t2 - t1;
-    Point3D y = t3 - t1;
-    Point3D z = pointCross(x, y).normalize();
+static void impactSweepSphereShape(SweepImpact& best, const Point3D& c1,
+                                   const Point3D& d, coord_t r,
+                                   const CollisionShape& shape) {
+    switch (shape.type) {
+        case CollisionShapeType::Point:
+            impactSweepSphereSphere(best, c1, d, r, shape.p, 0);
+            break;
+        case CollisionShapeType::Line:
+            impactSweepSphereLine(best, c1, d, r, shape.p, shape.p1);
+            break;
+        case CollisionShapeType::Cuboid:
+            impactSweepSphereCuboid(best, c1, d, r, shape.p, shape.p1);
+            break;
+        case CollisionShapeType::Sphere:
+            impactSweepSphereSphere(best, c1, d, r, shape.p, shape.r);
+            break;
+        case CollisionShapeType::Tri:
+            impactSweepSphereTri(best, c1, d, r, shape.p, shape.p1, shape.p2);
+            break;
+        default:
+            never("invalid shape");
+    }
+}
 
-    auto [ax, ay, az] = pointRemapPlane(x, y, z, a);
-    auto [bx, by, bz] = pointRemapPlane(x, y, z, b);
-    (void)az;
-    (void)bz;
-    if (0 <= ax && ax <= 1 && 0 <= ay && ay <= 1 && ax + ay <= 1) return c1;
-    if (collides2DLineLine(ax, ay, bx, by, 0, 0, 1, 0))
-        return Point3D::lerp(
-            c1, collides2DLineLineWhereUnlerp(ax, ay, bx, by, 0, 0, 1, 0), c2);
-    if (collides2DLineLine(ax, ay, bx, by, 0, 0, 0, 1))
-        return Point3D::lerp(
-            c1, collides2DLineLineWhereUnlerp(ax, ay, bx, by, 0, 0, 0, 1), c2);
-    if (collides2DLineLine(ax, ay, bx, by, 1, 0, 0, 1))
-        return Point3D::lerp(
-            c1, collides2DLineLineWhereUnlerp(ax, ay, bx, by, 1, 0, 0, 1), c2);
-    return c1;
-}
-
-bool collidesPointShape(const Point3D& p, const CollisionShape& shape,
-                        const Matrix3D& mat) {
+static SweepImpact finishImpact(SweepImpact&& best, const Point3D& c1,
+                                const Point3D& c2) {
+    if (best.hit) best.center = Point3D::lerp(c1, best.t, c2);
+    return best;
+}
+
+SweepImpact collidesSweepSphereSphereImpact(const Point3D& c1,
+                                            const Point3D& c2, coord_t r,
+                                            const Point3D& sc, coord_t sr) {
+    SweepImpact best;
+    impactSweepSphereSphere(best, c1, c2 - c1, r, sc, sr);
+    return finishImpact(std::move(best), c1, c2);
+}
+
+SweepImpact collidesSweepSphereCuboidImpact(const Point3D& c1,
+                                            const Point3D& c2, coord_t r,
+                                            const Point3D& q1,
+                                            const Point3D& q2) {
+    SweepImpact best;
+    impactSweepSphereCuboid(best, c1, c2 - c1, r, q1, q2);
+    return finishImpact(std::move(best), c1, c2);
+}
+
+SweepImpact collidesSweepSphereShapeImpact(const Point3D& c1,
+                                           const Point3D& c2, coord_t r,
+                                           const CollisionShape& shape) {
+    SweepImpact best;
+    impactSweepSphereShape(best, c1, c2 - c1, r, shape);
+    return finishImpact(std::move(best), c1, c2);
+}
+
+CollisionShape transformShape(const CollisionShape& shape,
+                              const Matrix3DAffine& mat) {
+    perfStats.add(Stat::ShapeTransforms);
+    CollisionShape w = shape;
+    w.p = mat.project(shape.p);
+    switch (shape.type) {
+        case CollisionShapeType::Tri:
+            w.p2 = mat.project(shape.p2);
+            [[fallthrough]];
+        case CollisionShapeType::Line:
+        case CollisionShapeType::Cuboid:
+            w.p1 = mat.project(shape.p1);
+            break;
+        default:
+            break;
+    }
+    return w;
+}
+
+// left behind by destroyed caches, vectors and all. never destroyed, like the
+// object pools, so that caches destroyed at exit can still put theirs here
+static std::vector<std::unique_ptr<ModelCollision>>& spareWorlds() {
+    static auto* spare = new std::vector<std::unique_ptr<ModelCollision>>();
+    return *spare;
+}
+
+WorldCollisionCache::~WorldCollisionCache() {
+    if (world_) spareWorlds().push_back(std::move(world_));
+}
+
+const ModelCollision& WorldCollisionCache::get(const ModelCollision& mc,
+                                               const Matrix3DAffine& mat) {
+    if (!world_) {
+        auto& spare = spareWorlds();
+        if (spare.empty()) {
+            world_ = std::make_unique<ModelCollision>();
+        } else {
+            world_ = std::move(spare.back());
+            spare.pop_back();
+        }
+    }
+    if (src_ != &mc || !(mat_ == mat)) {
+        world_->shapes.clear();
+        for (const CollisionShape& shape : mc.shapes)
+            world_->shapes.push_back(transformShape(shape, mat));
+        world_->update();
+        src_ = &mc;
+        mat_ = mat;
+    }
+    return *world_;
+}
+
+// how far outside the bounds a query may still hit a shape
+static const coord_t boundsSlack = 1.0 / 256;
+
+static void extendBox(Point3D& lo, Point3D& hi, const Point3D& p, coord_t r) {
+    lo.x = std::min(lo.x, p.x - r), hi.x = std::max(hi.x, p.x + r);
+    lo.y = std::min(lo.y, p.y - r), hi.y = std::max(hi.y, p.y + r);
+    lo.z = std::min(lo.z, p.z - r), hi.z = std::max(hi.z, p.z + r);
+}
+
+void ModelCollision::update() {
+    points.clear();
+    lines.clear();
+    cuboids.clear();
+    spheres.clear();
+    tris.clear();
+    if (shapes.empty()) {
+        boxMin = boxMax = Point3D(0, 0, 0);
+        bounds = CollisionSphere{Point3D(0, 0, 0), -1};
+        return;
+    }
+
+    const coord_t inf = std::numeric_limits<coord_t>::infinity();
+    Point3D lo(inf, inf, inf), hi(-inf, -inf, -inf);
+    for (const CollisionShape& shape : shapes) {
+        switch (shape.type) {
+            case CollisionShapeType::Point:
+                points.push_back(shape.p);
+                extendBox(lo, hi, shape.p, 0);
+                break;
+            case CollisionShapeType::Line:
+                lines.push_back(CollisionLine{shape.p, shape.p1});
+                extendBox(lo, hi, shape.p, 0);
+                extendBox(lo, hi, shape.p1, 0);
+                break;
+            case CollisionShapeType::Cuboid:
+                cuboids.push_back(CollisionCuboid{shape.p, shape.p1});
+                extendBox(lo, hi, shape.p, 0);
+                extendBox(lo, hi, shape.p1, 0);
+                break;
+            case CollisionShapeType::Sphere:
+                spheres.push_back(CollisionSphere{shape.p, shape.r});
+                extendBox(lo, hi, shape.p, shape.r);
+                break;
+            case CollisionShapeType::Tri:
+                tris.push_back(CollisionTri{shape.p, shape.p1, shape.p2});
+                extendBox(lo, hi, shape.p, 0);
+                extendBox(lo, hi, shape.p1, 0);
+                extendBox(lo, hi, shape.p2, 0);
+                break;
+            default:
+                never("invalid shape");
+        }
+    }
+    boxMin = lo;
+    boxMax = hi;
+
+    // centered on the box; the farthest point of any shape gives the radius
+    Point3D c = Point3D::average(lo, hi);
+    coord_t r = 0;
+    auto reach = [&](const Point3D& p, coord_t pr) {
+        r = std::max(r, distanceEuclidean(p, c) + pr);
+    };
+    for (const Point3D& p : points) reach(p, 0);
+    for (const CollisionLine& l : lines) reach(l.p1, 0), reach(l.p2, 0);
+    for (const CollisionCuboid& q : cuboids) {
+        // every corner, since the box is not centered on c
+        reach(q.c1, 0), reach(q.c2, 0);
+        reach(Point3D(q.c1.x, q.c1.y, q.c2.z), 0);
+        reach(Point3D(q.c1.x, q.c2.y, q.c1.z), 0);
+        reach(Point3D(q.c1.x, q.c2.y, q.c2.z), 0);
+        reach(Point3D(q.c2.x, q.c1.y, q.c1.z), 0);
+        reach(Point3D(q.c2.x, q.c1.y, q.c2.z), 0);
+        reach(Point3D(q.c2.x, q.c2.y, q.c1.z), 0);
+    }
+    for (const CollisionSphere& sp : spheres) reach(sp.center, sp.radius);
+    for (const CollisionTri& t : tris)
+        reach(t.t1, 0), reach(t.t2, 0), reach(t.t3, 0);
+    bounds = CollisionSphere{c, r};
+}
+
+// these return false if nothing closer than r to the point, segment or box
+// can touch any shape of mc
+static bool nearBounds(const ModelCollision& mc, const Point3D& p,
+                       coord_t r) {
+    return collidesSphereCuboid(p, r + boundsSlack, mc.boxMin, mc.boxMax);
+}
+
+static bool nearBounds(const ModelCollision& mc, const Point3D& p1,
+                       const Point3D& p2, coord_t r) {
+    Point3D d = p2 - p1;
+    coord_t dd = d.dot(d);
+    coord_t t =
+        dd > 0 ? clamp<coord_t>(0, (mc.bounds.center - p1).dot(d) / dd, 1) : 0;
+    return distanceEuclidean(p1 + d * t, mc.bounds.center) <=
+           mc.bounds.radius + r + boundsSlack;
+}
+
+// the box between two corners (in any order)
+static bool nearBoundsBox(const ModelCollision& mc, const Point3D& c1,
+                          const Point3D& c2) {
+    return collidesRangeRange(c1.x, c2.x, mc.boxMin.x - boundsSlack,
+                              mc.boxMax.x + boundsSlack) &&
+           collidesRangeRange(c1.y, c2.y, mc.boxMin.y - boundsSlack,
+                              mc.boxMax.y + boundsSlack) &&
+           collidesRangeRange(c1.z, c2.z, mc.boxMin.z - boundsSlack,
+                              mc.boxMax.z + boundsSlack);
+}
+
+// calls test with every shape of mc moved to world space by mat, until it
+// returns true
+template <typename F>
+static bool anyShape(const ModelCollision& mc, const Matrix3DAffine& mat,
+                     F&& test) {
+    return std::any_of(mc.shapes.begin(), mc.shapes.end(),
+                       [&](const CollisionShape& shape) {
+                           return test(transformShape(shape, mat));
+                       });
+}
+
+static bool collidesPointShape(const Point3D& p, const CollisionShape& shape) {
     switch (shape.type) {
         case CollisionShapeType::Point:
         case CollisionShapeType::Line:
         case CollisionShapeType::Tri:
             return false;
         case CollisionShapeType::Cuboid:
-            return collidesPointCuboid(p, mat.project(shape.p),
-                                       mat.project(shape.p1));
+            return collidesPointCuboid(p, shape.p, shape.p1);
         case CollisionShapeType::Sphere:
-            return collidesPointSphere(p, mat.project(shape.p), shape.r);
+            return collidesPointSphere(p, shape.p, shape.r);
         default:
             never("invalid shape");
     }
 }
 
 bool collidesLineShape(const Point3D& p1, const Point3D& p2,
-                       const CollisionShape& shape, const Matrix3D& mat) {
+                       const CollisionShape& shape) {
     switch (shape.type) {
         case CollisionShapeType::Point:
         case CollisionShapeType::Line:
             return false;
         case CollisionShapeType::Cuboid:
-            return collidesLineCuboid(p1, p2, mat.project(shape.p),
-                                      mat.project(shape.p1));
+            return collidesLineCuboid(p1, p2, shape.p, shape.p1);
         case CollisionShapeType::Sphere:
-            return collidesLineSphere(p1, p2, mat.project(shape.p), shape.r);
+            return collidesLineSphere(p1, p2, shape.p, shape.r);
         case CollisionShapeType::Tri:
-            return collidesLineTri(p1, p2, mat.project(shape.p),
-                                   mat.project(shape.p1),
-                                   mat.project(shape.p2));
+            return collidesLineTri(p1, p2, shape.p, shape.p1, shape.p2);
         default:
             never("invalid shape");
     }
 }
 
 bool collidesCuboidShape(const Point3D& c1, const Point3D& c2,
-                         const CollisionShape& shape, const Matrix3D& mat) {
+                         const CollisionShape& shape) {
     switch (shape.type) {
         case CollisionShapeType::Point:
-            return collidesCuboidPoint(c1, c2, mat.project(shape.p));
+            return collidesCuboidPoint(c1, c2, shape.p);
         case CollisionShapeType::Line:
-            return collidesCuboidLine(c1, c2, mat.project(shape.p),
-                                      mat.project(shape.p1));
+            return collidesCuboidLine(c1, c2, shape.p, shape.p1);
         case CollisionShapeType::Cuboid:
-            return collidesCuboidCuboid(c1, c2, mat.project(shape.p),
-                                        mat.project(shape.p1));
+            return collidesCuboidCuboid(c1, c2, shape.p, shape.p1);
         case CollisionShapeType::Sphere:
-            return collidesCuboidSphere(c1, c2, mat.project(shape.p), shape.r);
+            return collidesCuboidSphere(c1, c2, shape.p, shape.r);
         case CollisionShapeType::Tri:
-            return collidesCuboidTri(c1, c2, mat.project(shape.p),
-                                     mat.project(shape.p1),
-                                     mat.project(shape.p2));
+            return collidesCuboidTri(c1, c2, shape.p, shape.p1, shape.p2);
         default:
             never("invalid shape");
     }
 }
 
 bool collidesSphereShape(const Point3D& c, coord_t r,
-                         const CollisionShape& shape, const Matrix3D& mat) {
+                         const CollisionShape& shape) {
     switch (shape.type) {
         case CollisionShapeType::Point:
-            return collidesSpherePoint(c, r, mat.project(shape.p));
+            return collidesSpherePoint(c, r, shape.p);
         case CollisionShapeType::Line:
-            return collidesSphereLine(c, r, mat.project(shape.p),
-                                      mat.project(shape.p1));
+            return collidesSphereLine(c, r, shape.p, shape.p1);
         case CollisionShapeType::Cuboid:
-            return collidesSphereCuboid(c, r, mat.project(shape.p),
-                                        mat.project(shape.p1));
+            return collidesSphereCuboid(c, r, shape.p, shape.p1);
         case CollisionShapeType::Sphere:
-            return collidesSphereSphere(c, r, mat.project(shape.p), shape.r);
+            return collidesSphereSphere(c, r, shape.p, shape.r);
         case CollisionShapeType::Tri:
-            return collidesSphereTri(c, r, mat.project(shape.p),
-                                     mat.project(shape.p1),
-                                     mat.project(shape.p2));
+            return collidesSphereTri(c, r, shape.p, shape.p1, shape.p2);
         default:
             never("invalid shape");
     }
 }
 
 static bool collidesTriShape(const Point3D& t0, const Point3D& t1,
-                             const Point3D& t2, const CollisionShape& shape,
-                             const Matrix3D& mat) {
+                             const Point3D& t2, const CollisionShape& shape) {
     switch (shape.type) {
         case CollisionShapeType::Point:
             return false;
         case CollisionShapeType::Line:
-            return collidesLineTri(mat.project(shape.p), mat.project(shape.p1),
-                                   t0, t1, t2);
+            return collidesLineTri(shape.p, shape.p1, t0, t1, t2);
         case CollisionShapeType::Cuboid:
-            return collidesCuboidTri(mat.project(shape.p),
-                                     mat.project(shape.p1), t0, t1, t2);
+            return collidesCuboidTri(shape.p, shape.p1, t0, t1, t2);
         case CollisionShapeType::Sphere:
-            return collidesSphereTri(mat.project(shape.p), shape.r, t0, t1, t2);
+            return collidesSphereTri(shape.p, shape.r, t0, t1, t2);
         case CollisionShapeType::Tri:
-            return collidesTriTri(mat.project(shape.p), mat.project(shape.p1),
-                                  mat.project(shape.p2), t0, t1, t2);
+            return collidesTriTri(shape.p, shape.p1, shape.p2, t0, t1, t2);
         default:
             never("invalid shape");
     }
 }
 
-bool collidesPointModel(const Point3D& p, const ModelCollision& mc,
-                        const Matrix3D& mat) {
-    return std::any_of(mc.shapes.begin(), mc.shapes.end(),
-                       [&](const CollisionShape& shape) {
-                           return collidesPointShape(p, shape, mat);
-                       });
+bool collidesLineShape(const Point3D& p1, const Point3D& p2,
+                       const CollisionShape& shape, const Matrix3DAffine& mat) {
+    return collidesLineShape(p1, p2, transformShape(shape, mat));
+}
+
+bool collidesCuboidShape(const Point3D& c1, const Point3D& c2,
+                         const CollisionShape& shape,
+                         const Matrix3DAffine& mat) {
+    return collidesCuboidShape(c1, c2, transformShape(shape, mat));
+}
+
+bool collidesSphereShape(const Point3D& c, coord_t r,
+                         const CollisionShape& shape,
+                         const Matrix3DAffine& mat) {
+    return collidesSphereShape(c, r, transformShape(shape, mat));
+}
+
+static bool collidesPointModel(const Point3D& p, const ModelCollision& mc) {
+    if (!nearBounds(mc, p, 0)) return false;
+    for (const CollisionCuboid& q : mc.cuboids)
+        if (collidesPointCuboid(p, q.c1, q.c2)) return true;
+    for (const CollisionSphere& sp : mc.spheres)
+        if (collidesPointSphere(p, sp.center, sp.radius)) return true;
+    return false;
 }
 
 bool collidesLineModel(const Point3D& p1, const Point3D& p2,
-                       const ModelCollision& mc, const Matrix3D& mat) {
-    return std::any_of(mc.shapes.begin(), mc.shapes.end(),
-                       [&](const CollisionShape& shape) {
-                           return collidesLineShape(p1, p2, shape, mat);
-                       });
+                       const ModelCollision& mc) {
+    if (!nearBounds(mc, p1, p2, 0)) return false;
+    for (const CollisionCuboid& q : mc.cuboids)
+        if (collidesLineCuboid(p1, p2, q.c1, q.c2)) return true;
+    for (const CollisionSphere& sp : mc.spheres)
+        if (collidesLineSphere(p1, p2, sp.center, sp.radius)) return true;
+    for (const CollisionTri& t : mc.tris)
+        if (collidesLineTri(p1, p2, t.t1, t.t2, t.t3)) return true;
+    return false;
 }
 
 bool collidesCuboidModel(const Point3D& c1, const Point3D& c2,
-                         const ModelCollision& mc, const Matrix3D& mat) {
-    return std::any_of(mc.shapes.begin(), mc.shapes.end(),
-                       [&](const CollisionShape& shape) {
-                           return collidesCuboidShape(c1, c2, shape, mat);
-                       });
+                         const ModelCollision& mc) {
+    if (!nearBoundsBox(mc, c1, c2)) return false;
+    for (const Point3D& p : mc.points)
+        if (collidesCuboidPoint(c1, c2, p)) return true;
+    for (const CollisionLine& l : mc.lines)
+        if (collidesCuboidLine(c1, c2, l.p1, l.p2)) return true;
+    for (const CollisionCuboid& q : mc.cuboids)
+        if (collidesCuboidCuboid(c1, c2, q.c1, q.c2)) return true;
+    for (const CollisionSphere& sp : mc.spheres)
+        if (collidesCuboidSphere(c1, c2, sp.center, sp.radius)) return true;
+    for (const CollisionTri& t : mc.tris)
+        if (collidesCuboidTri(c1, c2, t.t1, t.t2, t.t3)) return true;
+    return false;
 }
 
-bool collidesSphereModel(const Point3D& c, coord_t r2, const ModelCollision& mc,
-                         const Matrix3D& mat) {
-    return std::any_of(mc.shapes.begin(), mc.shapes.end(),
-                       [&](const CollisionShape& shape) {
-                           return collidesSphereShape(c, r2, shape, mat);
-                       });
+bool collidesSphereModel(const Point3D& c, coord_t r,
+                         const ModelCollision& mc) {
+    if (!nearBounds(mc, c, r)) return false;
+    for (const Point3D& p : mc.points)
+        if (collidesSpherePoint(c, r, p)) return true;
+    for (const CollisionLine& l : mc.lines)
+        if (collidesSphereLine(c, r, l.p1, l.p2)) return true;
+    for (const CollisionCuboid& q : mc.cuboids)
+        if (collidesSphereCuboid(c, r, q.c1, q.c2)) return true;
+    for (const CollisionSphere& sp : mc.spheres)
+        if (collidesSphereSphere(c, r, sp.center, sp.radius)) return true;
+    for (const CollisionTri& t : mc.tris)
+        if (collidesSphereTri(c, r, t.t1, t.t2, t.t3)) return true;
+    return false;
 }
 
 static bool collidesTriModel(const Point3D& t0, const Point3D& t1,
-                             const Point3D& t2, const ModelCollision& mc,
-                             const Matrix3D& mat) {
-    return std::any_of(mc.shapes.begin(), mc.shapes.end(),
-                       [&](const CollisionShape& shape) {
-                           return collidesTriShape(t0, t1, t2, shape, mat);
-                       });
+                             const Point3D& t2, const ModelCollision& mc) {
+    Point3D lo = t0, hi = t0;
+    extendBox(lo, hi, t1, 0);
+    extendBox(lo, hi, t2, 0);
+    if (!nearBoundsBox(mc, lo, hi)) return false;
+    for (const CollisionLine& l : mc.lines)
+        if (collidesLineTri(l.p1, l.p2, t0, t1, t2)) return true;
+    for (const CollisionCuboid& q : mc.cuboids)
+        if (collidesCuboidTri(q.c1, q.c2, t0, t1, t2)) return true;
+    for (const CollisionSphere& sp : mc.spheres)
+        if (collidesSphereTri(sp.center, sp.radius, t0, t1, t2)) return true;
+    for (const CollisionTri& t : mc.tris)
+        if (collidesTriTri(t.t1, t.t2, t.t3, t0, t1, t2)) return true;
+    return false;
 }
 
+bool collidesModelModel(const ModelCollision& mc1, const ModelCollision& mc2) {
+    if (!nearBoundsBox(mc2, mc1.boxMin, mc1.boxMax)) return false;
+    for (const Point3D& p : mc1.points)
+        if (collidesPointModel(p, mc2)) return true;
+    for (const CollisionLine& l : mc1.lines)
+        if (collidesLineModel(l.p1, l.p2, mc2)) return true;
+    for (const CollisionCuboid& q : mc1.cuboids)
+        if (collidesCuboidModel(q.c1, q.c2, mc2)) return true;
+    for (const CollisionSphere& sp : mc1.spheres)
+        if (collidesSphereModel(sp.center, sp.radius, mc2)) return true;
+    for (const CollisionTri& t : mc1.tris)
+        if (collidesTriModel(t.t1, t.t2, t.t3, mc2)) return true;
+    return false;
+}
+
+// the versions with a model matrix test the shapes one by one, in order
+
+bool collidesLineModel(const Point3D& p1, const Point3D& p2,
+                       const ModelCollision& mc, const Matrix3DAffine& mat) {
+    return anyShape(mc, mat, [&](const CollisionShape& shape) {
+        return collidesLineShape(p1, p2, shape);
+    });
+}
+
+bool collidesCuboidModel(const Point3D& c1, const Point3D& c2,
+                         const ModelCollision& mc, const Matrix3DAffine& mat) {
+    return anyShape(mc, mat, [&](const CollisionShape& shape) {
+        return collidesCuboidShape(c1, c2, shape);
+    });
+}
+
+bool collidesSphereModel(const Point3D& c, coord_t r2, const ModelCollision& mc,
+                         const Matrix3DAffine& mat) {
+    return anyShape(mc, mat, [&](const CollisionShape& shape) {
+        return collidesSphereShape(c, r2, shape);
+    });
+}
+
+// shape is in world space
 static bool collidesShapeModel(const CollisionShape& shape,
-                               const Matrix3D& mat1, const ModelCollision& mc,
-                               const Matrix3D& mat2) {
-    switch (shape.type) {
-        case CollisionShapeType::Point:
-            return collidesPointModel(mat1.project(shape.p), mc, mat2);
-        case CollisionShapeType::Line:
-            return collidesLineModel(mat1.project(shape.p),
-                                     mat1.project(shape.p1), mc, mat2);
-        case CollisionShapeType::Cuboid:
-            return collidesCuboidModel(mat1.project(shape.p),
-                                       mat1.project(shape.p1), mc, mat2);
-        case CollisionShapeType::Sphere:
-            return collidesSphereModel(mat1.project(shape.p), shape.r, mc,
-                                       mat2);
-        case CollisionShapeType::Tri:
-            return collidesTriModel(mat1.project(shape.p),
-                                    mat1.project(shape.p1),
-                                    mat1.project(shape.p2), mc, mat2);
-        default:
-            never("invalid shape");
-    }
+                               const ModelCollision& mc,
+                               const Matrix3DAffine& mat) {
+    return anyShape(mc, mat, [&](const CollisionShape& other) {
+        switch (shape.type) {
+            case CollisionShapeType::Point:
+                return collidesPointShape(shape.p, other);
+            case CollisionShapeType::Line:
+                return collidesLineShape(shape.p, shape.p1, other);
+            case CollisionShapeType::Cuboid:
+                return collidesCuboidShape(shape.p, shape.p1, other);
+            case CollisionShapeType::Sphere:
+                return collidesSphereShape(shape.p, shape.r, other);
+            case CollisionShapeType::Tri:
+                return collidesTriShape(shape.p, shape.p1, shape.p2, other);
+            default:
+                never("invalid shape");
+        }
+    });
 }
 
-bool collidesModelModel(const ModelCollision& mc1, const Matrix3D& mat1,
-                        const ModelCollision& mc2, const Matrix3D& mat2) {
-    return std::any_of(mc1.shapes.begin(), mc1.shapes.end(),
-                       [&](const CollisionShape& shape) {
-                           return collidesShapeModel(shape, mat1, mc2, mat2);
-                       });
+bool collidesModelModel(const ModelCollision& mc1, const Matrix3DAffine& mat1,
+                        const ModelCollision& mc2, const Matrix3DAffine& mat2) {
+    return anyShape(mc1, mat1, [&](const CollisionShape& shape) {
+        return collidesShapeModel(shape, mc2, mat2);
+    });
 }
 
 static bool collidesSweepSphereShape(const Point3D& c1, const Point3D& c2,
-                                     coord_t r, const CollisionShape& shape,
-                                     const Matrix3D& mat) {
+                                     coord_t r, const CollisionShape& shape) {
     switch (shape.type) {
         case CollisionShapeType::Point:
-            return collidesSweepSpherePoint(c1, c2, r, mat.project(shape.p));
+            return collidesSweepSpherePoint(c1, c2, r, shape.p);
         case CollisionShapeType::Line:
-            return collidesSweepSphereLine(c1, c2, r, mat.project(shape.p),
-                                           mat.project(shape.p1));
+            return collidesSweepSphereLine(c1, c2, r, shape.p, shape.p1);
         case CollisionShapeType::Cuboid:
-            return collidesSweepSphereCuboid(c1, c2, r, mat.project(shape.p),
-                                             mat.project(shape.p1));
+            return collidesSweepSphereCuboid(c1, c2, r, shape.p, shape.p1);
         case CollisionShapeType::Sphere:
-            return collidesSweepSphereSphere(c1, c2, r, mat.project(shape.p),
-                                             shape.r);
+            return collidesSweepSphereSphere(c1, c2, r, shape.p, shape.r);
         case CollisionShapeType::Tri:
-            return collidesSweepSphereTri(c1, c2, r, mat.project(shape.p),
-                                          mat.project(shape.p1),
-                                          mat.project(shape.p2));
+            return collidesSweepSphereTri(c1, c2, r, shape.p, shape.p1,
+                                          shape.p2);
         default:
             never("invalid shape");
     }
 }
 
-static Point3D collidesSweepSphereShapeWhere(const Point3D& c1,
-                                             const Point3D& c2, coord_t r,
-                                             const CollisionShape& shape,
-                                             const Matrix3D& mat) {
-    switch (shape.type) {
-        case CollisionShapeType::Point:
-            return collidesSweepSpherePointWhere(c1, c2, r,
-                                                 mat.project(shape.p));
-        case CollisionShapeType::Line:
-            return collidesSweepSphereLineWhere(c1, c2, r, mat.project(shape.p),
-                                                mat.project(shape.p1));
-        case CollisionShapeType::Cuboid:
-            return collidesSweepSphereCuboidWhere(
-                c1, c2, r, mat.project(shape.p), mat.project(shape.p1));
-        case CollisionShapeType::Sphere:
-            return collidesSweepSphereSphereWhere(
-                c1, c2, r, mat.project(shape.p), shape.r);
-        case CollisionShapeType::Tri:
-            return collidesSweepSphereTriWhere(c1, c2, r, mat.project(shape.p),
-                                               mat.project(shape.p1),
-                                               mat.project(shape.p2));
-        default:
-            never("invalid shape");
-    }
+bool collidesSweepSphereModel(const Point3D& c1, const Point3D& c2, coord_t r,
+                              const ModelCollision& mc,
+                              const Matrix3DAffine& mat) {
+    return anyShape(mc, mat, [&](const CollisionShape& shape) {
+        return collidesSweepSphereShape(c1, c2, r, shape);
+    });
 }
 
 bool collidesSweepSphereModel(const Point3D& c1, const Point3D& c2, coord_t r,
-                              const ModelCollision& mc, const Matrix3D& mat) {
-    return std::any_of(
-        mc.shapes.begin(), mc.shapes.end(), [&](const CollisionShape& shape) {
-            return collidesSweepSphereShape(c1, c2, r, shape, mat);
-        });
-}
-
-Point3D collidesSweepSphereModelWhere(const Point3D& l1, const Point3D& l2,
-                                      coord_t r, const ModelCollision& mc,
-                                      const Matrix3D& mat) {
-    for (const CollisionShape& shape : mc.shapes) {
-        if (collidesSweepSphereShape(l1, l2, r, shape, mat))
-            return collidesSweepSphereShapeWhere(l1, l2, r, shape, mat);
+                              const ModelCollision& mc) {
+    if (!nearBounds(mc, c1, c2, r)) return false;
+    for (const Point3D& p : mc.points)
+        if (collidesSweepSpherePoint(c1, c2, r, p)) return true;
+    for (const CollisionLine& l : mc.lines)
+        if (collidesSweepSphereLine(c1, c2, r, l.p1, l.p2)) return true;
+    for (const CollisionCuboid& q : mc.cuboids)
+        if (collidesSweepSphereCuboid(c1, c2, r, q.c1, q.c2)) return true;
+    for (const CollisionSphere& sp : mc.spheres)
+        if (collidesSweepSphereSphere(c1, c2, r, sp.center, sp.radius))
+            return true;
+    for (const CollisionTri& t : mc.tris)
+        if (collidesSweepSphereTri(c1, c2, r, t.t1, t.t2, t.t3)) return true;
+    return false;
+}
+
+// the shapes are tested in their original order, so that of two shapes hit
+// at the same time, the first one is reported
+SweepImpact collidesSweepSphereModelImpact(const Point3D& c1,
+                                           const Point3D& c2, coord_t r,
+                                           const ModelCollision& mc,
+                                           const Matrix3DAffine& mat) {
+    SweepImpact best;
+    Point3D d = c2 - c1;
+    for (size_t i = 0; i < mc.shapes.size() && best.t > 0; ++i) {
+        SweepImpact s;
+        impactSweepSphereShape(s, c1, d, r, transformShape(mc.shapes[i], mat));
+        if (s.hit && (!best.hit || s.t < best.t)) best = s, best.shape = i;
+    }
+    return finishImpact(std::move(best), c1, c2);
+}
+
+SweepImpact collidesSweepSphereModelImpact(const Point3D& c1,
+                                           const Point3D& c2, coord_t r,
+                                           const ModelCollision& mc) {
+    SweepImpact best;
+    if (!nearBounds(mc, c1, c2, r)) return best;
+    Point3D d = c2 - c1;
+    for (size_t i = 0; i < mc.shapes.size() && best.t > 0; ++i) {
+        SweepImpact s;
+        impactSweepSphereShape(s, c1, d, r, mc.shapes[i]);
+        if (s.hit && (!best.hit || s.t < best.t)) best = s, best.shape = i;
     }
-    return l1;
+    return finishImpact(std::move(best), c1, c2);
 }
 
 Point3D collidesCuboidPointDirection(const Point3D& them, const Point3D& me,
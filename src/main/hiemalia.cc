@@ -8,8 +8,11 @@
 
 #include "hiemalia.hh"
 
+#include <algorithm>
+#include <chrono>
 #include <exception>
 #include <iostream>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -17,21 +20,33 @@
 #include "assets.hh"
 #include "debugger.hh"
 #include "file.hh"
+#include "game/bench.hh"
+#include "game/demo.hh"
 #include "game/gamemsg.hh"
 #include "hbase.hh"
 #include "hholder.hh"
 #include "logger.hh"
 #include "logic.hh"
 #include "mholder.hh"
+#include "random.hh"
 #include "scores.hh"
+#include "stats.hh"
 #include "sys.hh"
+#include "worker.hh"
 
 namespace hiemalia {
 
 static bool keepConsoleOpen = false;
+static bool showStats = false;
+static bool pipelined = false;
+static std::string dumpFrames;
+static bool headless = false;
+static uint64_t headlessTicks = 0;
+static std::string headlessDemo;
+static std::string benchName;
 
 Hiemalia::Hiemalia(const std::string &command)
-    : command_(command), host_(getHostModule()) {}
+    : command_(command) {}
 
 Hiemalia::Hiemalia(Hiemalia &&move) noexcept
     : command_(std::move(move.command_)),
@@ -60,6 +75,10 @@ void Hiemalia::gotMessage(const HostMessage &msg) {
             if (state_.arcade) resetArcade();
             break;
         case HostMessageType::MainMenuFromDemo:
+            if (headless) {
+                host_->quit();
+                break;
+            }
             sendMessage(AudioMessage::unmute());
             sendMessage(
                 LogicMessage::mainMenuFromDemo(modules_, state_.arcade));
@@ -133,6 +152,26 @@ void Hiemalia::args(std::vector<std::string> args) {
             ss << "        arcade mode (full screen, no main menu,\n";
             ss << "            no options menu (configure beforehand),\n";
             ss << "            takes credits, quits only on Alt+F4)\n\n";
+            ss << "  --pipeline\n";
+            ss << "        run game logic on a worker thread while the\n";
+            ss << "            previous frame is drawn (adds one tick of\n";
+            ss << "            display latency); also works with\n";
+            ss << "            --headless\n\n";
+            ss << "  --headless\n";
+            ss << "        no window, sound or input; plays the demo as fast\n";
+            ss << "            as possible and prints a timing report\n\n";
+            ss << "  --ticks <N>\n";
+            ss << "        with --headless, stop after N ticks\n\n";
+            ss << "  --demo <file>\n";
+            ss << "        with --headless, play this demo instead\n\n";
+            ss << "  --dumpframes <file.png|file.ppm>\n";
+            ss << "        save one frame every second, numbered, if the\n";
+            ss << "            video backend supports it (soft)\n\n";
+            ss << "  --stats\n";
+            ss << "        print performance counters on exit\n\n";
+            ss << "  --bench <name>\n";
+            ss << "        run a benchmark and exit\n";
+            ss << "            (broadphase, bullets, vertex)\n\n";
             sysDisplayHelp(ss.str());
             std::exit(EXIT_SUCCESS);
         } else if (arg == "--console") {
@@ -141,6 +180,32 @@ void Hiemalia::args(std::vector<std::string> args) {
             keepConsoleOpen = true;
         } else if (arg == "--arcade") {
             state_.arcade = true;
+        } else if (arg == "--pipeline") {
+            pipelined = true;
+        } else if (arg == "--stats") {
+            showStats = true;
+        } else if (arg == "--headless") {
+            headless = true;
+        } else if (arg == "--ticks") {
+            if (++i >= args.size())
+                LOG_WARN("no argument for --ticks");
+            else
+                headlessTicks = fromString<uint64_t>(args[i]);
+        } else if (arg == "--demo") {
+            if (++i >= args.size())
+                LOG_WARN("no argument for --demo");
+            else
+                headlessDemo = args[i];
+        } else if (arg == "--bench") {
+            if (++i >= args.size())
+                LOG_WARN("no argument for --bench");
+            else
+                benchName = args[i];
+        } else if (arg == "--dumpframes") {
+            if (++i >= args.size())
+                LOG_WARN("no argument for --dumpframes");
+            else
+                dumpFrames = args[i];
         } else if (arg == "--config") {
             if (++i >= args.size())
                 LOG_WARN("no argument for --config");
@@ -181,6 +246,17 @@ void Hiemalia::args(std::vector<std::string> args) {
     }
 }
 
+// frame.png -> frame000060.png
+static void dumpFrame(uint64_t frame) {
+    if (dumpFrames.empty() || frame % tickCount) return;
+    size_t dot = dumpFrames.rfind('.');
+    if (dot == std::string::npos) dot = dumpFrames.size();
+    sendMessage(VideoMessage::dumpFrame(
+        substring(dumpFrames, 0, dot) +
+        stringFormat("%06llu", static_cast<unsigned long long>(frame)) +
+        substring(dumpFrames, dot, std::string::npos)));
+}
+
 void Hiemalia::run() {
     SplinterBuffer &sbuf = state_.sbuf;
     LOG_DEBUG("Loading assets");
@@ -189,12 +265,18 @@ void Hiemalia::run() {
             "Cannot load 'logo.2d'. You might be missing the game assets. "
             "Please redownload.");
     getAssets();
+    if (!benchName.empty()) {
+        if (!runBenchmark(benchName, std::cout))
+            LOG_ERROR("unknown benchmark '" + benchName + "'");
+        return;
+    }
 
+    host_ = getHostModule(headless);
     state_.config.load(configFileName);
     modules_ = std::make_shared<ModuleHolder>(host_, state_);
     overlay_ = std::make_shared<ArcadeOverlay>(modules_);
     ModuleHolder &m = *modules_;
-    if (state_.arcade) {
+    if (state_.arcade && !headless) {
         m.video->setFullScreenOrElse();
         host_->arcade();
     }
@@ -202,24 +284,190 @@ void Hiemalia::run() {
     state_.highScores = loadHighscores();
 
     host_->begin();
-    gotMessage(HostMessage::mainMenu());
+    if (headless) {
+        // so that two runs of the same build draw the same frames
+        seedRandomEngine(0);
+        if (!headlessDemo.empty()) useOnlyDemo(headlessDemo);
+        sendMessage(LogicMessage::startDemo(modules_));
+    } else
+        gotMessage(HostMessage::mainMenu());
     LOG_DEBUG("Entering main game loop");
-    while (host_->proceed()) {
-        m.video->frame(sbuf);
-        m.video->sync();
-        sbuf.clear();
-        m.audio->tick();
-        m.input->update(state_, tickInterval);
-        m.logic->run(state_, tickInterval);
-        overlay_->run(state_, tickInterval);
+    if (headless)
+        runHeadless();
+    else if (pipelined)
+        runPipelined();
+    else {
+        uint64_t frame = 0;
+        while (host_->proceed()) {
+            auto t0 = std::chrono::steady_clock::now();
+            m.video->frame(sbuf);
+            auto t1 = std::chrono::steady_clock::now();
+            dumpFrame(++frame);
+            m.video->sync();
+            sbuf.clear();
+            m.audio->tick();
+            m.input->update(state_, tickInterval);
+            auto t2 = std::chrono::steady_clock::now();
+            m.logic->run(state_, tickInterval);
+            overlay_->run(state_, tickInterval);
+            auto t3 = std::chrono::steady_clock::now();
+            perfStats.add(Stat::VideoMicros, microsBetween(t0, t1));
+            perfStats.add(Stat::LogicMicros, microsBetween(t2, t3));
+        }
     }
     LOG_DEBUG("Finishing up");
+    if (showStats) perfStats.report(std::cerr);
     host_->finish();
+    if (headless) return;
     saveHighscores(state_.highScores);
 
     state_.config.save(configFileName);
 }
 
+// logic for tick N+1 runs on the worker thread while the main thread draws
+// tick N from the other buffer
+void Hiemalia::runPipelined() {
+    ModuleHolder &m = *modules_;
+    WorkerThread worker;
+    SplinterBuffer front(DEFAULT_SCREEN_BUFFER_SIZE);
+    uint64_t frame = 0;
+    LOG_DEBUG("Using pipelined game loop");
+    m.video->deferConfig(true);
+    while (host_->proceed()) {
+        m.input->update(state_, tickInterval);
+        worker.start([this, &m] {
+            auto t0 = std::chrono::steady_clock::now();
+            m.logic->run(state_, tickInterval);
+            overlay_->run(state_, tickInterval);
+            auto t1 = std::chrono::steady_clock::now();
+            perfStats.add(Stat::LogicMicros, microsBetween(t0, t1));
+        });
+        auto t0 = std::chrono::steady_clock::now();
+        m.video->frame(front);
+        auto t1 = std::chrono::steady_clock::now();
+        perfStats.add(Stat::VideoMicros, microsBetween(t0, t1));
+        dumpFrame(++frame);
+        m.video->sync();
+        worker.wait();
+        std::swap(front, state_.sbuf);
+        state_.sbuf.clear();
+        m.audio->tick();
+    }
+    m.video->deferConfig(false);
+}
+
+static std::string timeShare(const char *name, uint64_t us, uint64_t total) {
+    return stringFormat("  %-8s %10.3f ms %6.1f%%\n", name, us / 1000.0,
+                        total ? 100.0 * us / total : 0.0);
+}
+
+// ticks after which the game should not allocate any more when running the
+// demo. after them, only a pool or buffer growing past its earlier peak does
+static constexpr uint64_t headlessWarmupTicks = 300;
+
+// no syncing at all; ends after headlessTicks or when the demo is over.
+// with --pipeline, logic for tick N+1 runs on a worker thread while the main
+// thread draws tick N, like in runPipelined
+void Hiemalia::runHeadless() {
+    ModuleHolder &m = *modules_;
+    std::unique_ptr<WorkerThread> worker;
+    SplinterBuffer front(DEFAULT_SCREEN_BUFFER_SIZE);
+    // the tick that is in front and not drawn yet, or zero
+    uint64_t pending = 0;
+    uint64_t ticks = 0, input = 0, logic = 0, video = 0, audio = 0, wait = 0;
+    size_t peakSplinters = 0, peakBytes = 0;
+#if COUNT_ALLOCS
+    // heap allocations after the warm-up and after the last tick before the
+    // demo ended
+    uint64_t warmAllocs = 0, allocs = 0;
+#endif
+    auto draw = [&](SplinterBuffer &sbuf, uint64_t frame) {
+        auto t0 = std::chrono::steady_clock::now();
+        peakSplinters = std::max(peakSplinters, sbuf.size());
+        peakBytes = std::max(peakBytes, sbuf.bytes());
+        m.video->frame(sbuf);
+        dumpFrame(frame);
+        sbuf.clear();
+        video += microsBetween(t0, std::chrono::steady_clock::now());
+    };
+    auto tick = [&] {
+        auto t0 = std::chrono::steady_clock::now();
+        m.logic->run(state_, tickInterval);
+        overlay_->run(state_, tickInterval);
+        logic += microsBetween(t0, std::chrono::steady_clock::now());
+    };
+    if (pipelined) {
+        LOG_DEBUG("Using pipelined headless game loop");
+        worker = std::make_unique<WorkerThread>();
+        m.video->deferConfig(true);
+    } else
+        LOG_DEBUG("Using headless game loop");
+    auto start = std::chrono::steady_clock::now();
+    while (host_->proceed() && (!headlessTicks || ticks < headlessTicks)) {
+        auto t0 = std::chrono::steady_clock::now();
+        m.input->update(state_, tickInterval);
+        input += microsBetween(t0, std::chrono::steady_clock::now());
+        ++ticks;
+        if (worker) {
+            worker->start(tick);
+            if (pending) draw(front, pending);
+            auto t1 = std::chrono::steady_clock::now();
+            worker->wait();
+            wait += microsBetween(t1, std::chrono::steady_clock::now());
+            std::swap(front, state_.sbuf);
+            pending = ticks;
+        } else {
+            tick();
+            draw(state_.sbuf, ticks);
+        }
+        auto t2 = std::chrono::steady_clock::now();
+        m.audio->tick();
+        audio += microsBetween(t2, std::chrono::steady_clock::now());
+#if COUNT_ALLOCS
+        // the tick that ends the demo formats the result, so it is left out
+        if (ticks == headlessWarmupTicks) warmAllocs = heapAllocations();
+        if (state_.demoResult.empty()) allocs = heapAllocations();
+#endif
+    }
+    if (pending) draw(front, pending);
+    uint64_t total =
+        microsBetween(start, std::chrono::steady_clock::now());
+    perfStats.add(Stat::LogicMicros, logic);
+    perfStats.add(Stat::VideoMicros, video);
+    m.video->deferConfig(false);
+
+    // when pipelined, logic overlaps the rest and wait is the part of it
+    // that the main thread had to wait for
+    uint64_t main = input + (worker ? wait : logic) + video + audio;
+    std::cout << stringFormat(
+        "headless%s: %llu ticks in %.3f s, %.1f ticks/s\n",
+        worker ? " (pipelined)" : "", static_cast<unsigned long long>(ticks),
+        total / 1e6, total ? ticks * 1e6 / total : 0.0);
+    std::cout << timeShare("input", input, total);
+    std::cout << timeShare("logic", logic, total);
+    std::cout << timeShare("video", video, total);
+    std::cout << timeShare("audio", audio, total);
+    if (worker) std::cout << timeShare("wait", wait, total);
+    std::cout << timeShare("other", total > main ? total - main : 0, total);
+    std::cout << stringFormat(
+        "peak splinter buffer: %llu splinters, %llu bytes\n",
+        static_cast<unsigned long long>(peakSplinters),
+        static_cast<unsigned long long>(peakBytes));
+#if COUNT_ALLOCS
+    if (ticks > headlessWarmupTicks) {
+        uint64_t steady = allocs - warmAllocs;
+        std::cout << stringFormat(
+            "heap allocations: %llu in the first %llu ticks, %llu after%s\n",
+            static_cast<unsigned long long>(warmAllocs),
+            static_cast<unsigned long long>(headlessWarmupTicks),
+            static_cast<unsigned long long>(steady),
+            steady ? " (should be 0)" : "");
+    }
+#endif
+    if (!state_.demoResult.empty())
+        std::cout << "demo ended: " << state_.demoResult << "\n";
+}
+
 [[noreturn]] void fail(const char *s) {
     debugger();
     std::string f = stringFormat(
@@ -17,6 +17,8 @@ static random_engine re{rd()};
 
 random_engine& getRandomEngine() { return re; }
 
+void seedRandomEngine(unsigned seed) { re.seed(seed); }
+
 RandomPool::RandomPool(int idx)
     : engine_(random_pool_engine(324331031U + 766710257U * idx)) {}
 
@@ -0,0 +1,95 @@
+/****************************************************************************/
+/*                                                                          */
+/*   HIEMALIA SOURCE CODE (C) 2021      SAMPO HIPPELAINEN (HISAHI).         */
+/*   SEE THE LICENSE FILE IN THE SOURCE ROOT DIRECTORY FOR LICENSE INFO.    */
+/*                                                                          */
+/****************************************************************************/
+// stats.cc: implementation of performance counters
+
+#include "stats.hh"
+
+#if COUNT_ALLOCS
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#endif
+
+#include "str.hh"
+
+#if COUNT_ALLOCS
+static std::atomic<uint64_t> heapAllocs{0};
+
+// the array and nothrow forms of new and delete end up in these. aligned new
+// is not counted, but nothing in the game is over-aligned
+void* operator new(std::size_t n) {
+    heapAllocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+#endif
+
+namespace hiemalia {
+PerfStats perfStats;
+
+static const char* statNames[] = {
+    "frames",
+    "splinters drawn",
+    "splinter buffer bytes",
+    "lines before clipping",
+    "lines after clipping",
+    "pixels filled",
+    "draw calls",
+    "trig calls for rotations",
+    "collision pairs tested",
+    "collision shapes transformed",
+    "peak explosions",
+    "peak explosion shards",
+    "explosion pool bytes",
+    "objects made in pools",
+    "object pool chunks allocated",
+    "object runs updated",
+    "peak enemy bullets",
+    "logic time (us)",
+    "video time (us)",
+};
+
+static_assert(sizeof(statNames) / sizeof(statNames[0]) ==
+                  static_cast<size_t>(Stat::Count_),
+              "statNames must match Stat");
+
+// high-water marks, not totals
+static bool isPeak(Stat s) {
+    return s == Stat::ParticleEmitters || s == Stat::ParticleShards ||
+           s == Stat::ParticleBytes || s == Stat::PeakBullets;
+}
+
+uint64_t heapAllocations() noexcept {
+#if COUNT_ALLOCS
+    return heapAllocs.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+void PerfStats::reset() noexcept {
+    for (uint64_t& c : counters_) c = 0;
+}
+
+void PerfStats::report(std::ostream& out) const {
+    uint64_t frames = get(Stat::Frames);
+    out << stringFormat("%-32s %12llu\n", statNames[0],
+                        static_cast<unsigned long long>(frames));
+    for (size_t i = 1; i < static_cast<size_t>(Stat::Count_); ++i) {
+        auto n = static_cast<unsigned long long>(counters_[i]);
+        if (frames && !isPeak(static_cast<Stat>(i)))
+            out << stringFormat("%-32s %12llu (%.1f / frame)\n", statNames[i],
+                                n, static_cast<double>(n) / frames);
+        else
+            out << stringFormat("%-32s %12llu\n", statNames[i], n);
+    }
+}
+}  // namespace hiemalia
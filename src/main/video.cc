@@ -9,7 +9,9 @@
 #include "video.hh"
 
 #include "hbase.hh"
+#include "logger.hh"
 #include "math.hh"
+#include "stats.hh"
 #include "vbase.hh"
 
 namespace hiemalia {
@@ -24,29 +26,46 @@ void VideoConfig::save(ConfigSectionStore store) const {
 VideoEngine::VideoEngine(const std::shared_ptr<HostModule>& host,
                          GameState& state)
     : video_(getVideoModule(host)),
-      config_(state.config.section<VideoConfig>()) {
+      config_(state.config.section<VideoConfig>()),
+      canSetFullScreen_(video_->canSetFullscreen()) {
     readConfig();
 }
 
-void VideoEngine::gotMessage(const VideoMessage& msg) {}
+void VideoEngine::gotMessage(const VideoMessage& msg) {
+    switch (msg.type) {
+        case VideoMessageType::DumpFrame:
+            if (!video_->dumpFrame(msg.filename))
+                LOG_WARN("could not dump frame to '%s'", msg.filename);
+            break;
+    }
+}
 
 void VideoEngine::frame(const SplinterBuffer& sbuf) {
+    if (configPending_.exchange(false)) applyConfig();
+    fullScreen_ = video_->isFullScreen();
     video_->frame();
     video_->blank();
     video_->draw(sbuf);
     video_->blit();
+    perfStats.add(Stat::Frames);
+    perfStats.add(Stat::Splinters, sbuf.size());
+    perfStats.add(Stat::SplinterBytes, sbuf.bytes());
 }
 
 void VideoEngine::sync() { video_->sync(); }
 
 void VideoEngine::readConfig() {
-    bool fullScreen = config_->fullScreen;
-    if (canSetFullScreen()) video_->setFullScreen(fullScreen);
+    if (deferConfig_)
+        configPending_ = true;
+    else
+        applyConfig();
 }
 
-bool VideoEngine::isFullScreen() { return video_->isFullScreen(); }
-
-bool VideoEngine::canSetFullScreen() { return video_->canSetFullscreen(); }
+void VideoEngine::applyConfig() {
+    bool fullScreen = config_->fullScreen;
+    if (canSetFullScreen_) video_->setFullScreen(fullScreen);
+    fullScreen_ = video_->isFullScreen();
+}
 
 void VideoEngine::setFullScreenOrElse() {
     if (video_->isFullScreen()) return;
@@ -54,6 +73,7 @@ void VideoEngine::setFullScreenOrElse() {
         throw std::runtime_error(
             "current build of game does not support full screen modes");
     video_->setFullScreen(true);
+    fullScreen_ = video_->isFullScreen();
 }
 
 Color Color::fromHSVA(float h, float s, float v, float a) {
@@ -0,0 +1,62 @@
+/****************************************************************************/
+/*                                                                          */
+/*   HIEMALIA SOURCE CODE (C) 2021      SAMPO HIPPELAINEN (HISAHI).         */
+/*   SEE THE LICENSE FILE IN THE SOURCE ROOT DIRECTORY FOR LICENSE INFO.    */
+/*                                                                          */
+/****************************************************************************/
+// worker.cc: implementation of worker thread
+
+#include "worker.hh"
+
+#include <utility>
+
+#include "defs.hh"
+
+namespace hiemalia {
+WorkerThread::WorkerThread() : thread_([this] { loop(); }) {}
+
+WorkerThread::~WorkerThread() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        quit_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+}
+
+void WorkerThread::start(std::function<void()>&& job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        dynamic_assert(!busy_, "worker thread is already busy");
+        job_ = std::move(job);
+        busy_ = true;
+    }
+    cv_.notify_all();
+}
+
+void WorkerThread::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return !busy_; });
+    if (error_) std::rethrow_exception(std::exchange(error_, nullptr));
+}
+
+void WorkerThread::loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        cv_.wait(lock, [this] { return busy_ || quit_; });
+        if (quit_) return;
+        std::function<void()> job = std::move(job_);
+        lock.unlock();
+        try {
+            job();
+        } catch (...) {
+            lock.lock();
+            error_ = std::current_exception();
+            lock.unlock();
+        }
+        lock.lock();
+        busy_ = false;
+        cv_.notify_all();
+    }
+}
+}  // namespace hiemalia
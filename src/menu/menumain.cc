@@ -92,11 +92,12 @@ void MenuMain::renderSpecial(SplinterBuffer& sbuf, float interval) {
     progress(interval);
     Point3D p(0, 0, 0);
     Point3D scale(1, 1, 1);
+    tubes_.clear();
     for (size_t i = 0; i < (rots_.size() >> 3); ++i) {
-        rend_.renderModel(sbuf, p, Orient3D(0, 0, rots_[i << 3]), scale,
-                          *tube_);
+        tubes_.push_back({p, Orient3D(0, 0, rots_[i << 3]), scale});
         p.z += z_off;
     }
+    rend_.renderInstances(sbuf, *tube_, tubes_.data(), tubes_.size());
     rend2_.renderShapeColor(
         sbuf, 0, info().arcade ? 0 : -0.5,
         Color{255, 255, 255, static_cast<std::uint8_t>(192 + 60 * sin(angle_))},
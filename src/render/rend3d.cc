@@ -8,6 +8,7 @@
 
 #include "rend3d.hh"
 
+#include <algorithm>
 #include <cmath>
 #include <iomanip>
 #include <sstream>
@@ -16,6 +17,7 @@
 #include "math.hh"
 #include "sbuf.hh"
 #include "shape.hh"
+#include "stats.hh"
 
 namespace hiemalia {
 
@@ -32,16 +34,19 @@ Matrix3D3 Matrix3D3::scale(coord_t s) {
 }
 
 Matrix3D3 Matrix3D3::yaw(coord_t theta) {
+    perfStats.add(Stat::TrigCalls, 2);
     coord_t s = sin(theta), c = cos(theta);
     return Matrix3D3(c, 0, s, 0, 1, 0, -s, 0, c);
 }
 
 Matrix3D3 Matrix3D3::pitch(coord_t theta) {
+    perfStats.add(Stat::TrigCalls, 2);
     coord_t s = sin(theta), c = cos(theta);
     return Matrix3D3(1, 0, 0, 0, c, s, 0, -s, c);
 }
 
 Matrix3D3 Matrix3D3::roll(coord_t theta) {
+    perfStats.add(Stat::TrigCalls, 2);
     coord_t s = sin(theta), c = cos(theta);
     return Matrix3D3(c, -s, 0, s, c, 0, 0, 0, 1);
 }
@@ -99,11 +104,116 @@ Point3D Matrix3D::project(const Point3D& p) const {
     return project(Vector3D(p)).toCartesian();
 }
 
-Matrix3D Renderer3D::getModelMatrix(Point3D p, Orient3D r, Point3D s) {
-    Matrix3D wrld = Matrix3D::translate(p);
-    wrld *= Matrix3D3::rotate(r);
-    wrld *= Matrix3D3::scale(s);
-    return wrld;
+Quaternion Quaternion::fromOrient3D(const Orient3D& r) {
+    // yaw around y, then pitch around -x, then roll around z
+    Quaternion q = identity();
+    if (r.yaw != 0) {
+        perfStats.add(Stat::TrigCalls, 2);
+        q = Quaternion(cos(r.yaw * 0.5), 0, sin(r.yaw * 0.5), 0);
+    }
+    if (r.pitch != 0) {
+        perfStats.add(Stat::TrigCalls, 2);
+        q = q * Quaternion(cos(r.pitch * 0.5), -sin(r.pitch * 0.5), 0, 0);
+    }
+    if (r.roll != 0) {
+        perfStats.add(Stat::TrigCalls, 2);
+        q = q * Quaternion(cos(r.roll * 0.5), 0, 0, sin(r.roll * 0.5));
+    }
+    return q;
+}
+
+Quaternion Quaternion::fromAngularVelocity(const Point3D& omega,
+                                           coord_t dt) {
+    coord_t speed = omega.length();
+    if (speed == 0) return identity();
+    perfStats.add(Stat::TrigCalls, 2);
+    coord_t a = speed * dt * 0.5;
+    Point3D u = omega * (sin(a) / speed);
+    return Quaternion(cos(a), u.x, u.y, u.z);
+}
+
+Orient3D Quaternion::toOrient3D() const {
+    // the matrix of yaw * pitch * roll has sin(pitch) at m[5], cos(pitch)
+    // times the sine and cosine of yaw at m[2] and m[8], and of roll at m[3]
+    // and m[4]
+    perfStats.add(Stat::TrigCalls, 3);
+    Matrix3D3 m = toMatrix();
+    coord_t sp = std::clamp<coord_t>(m.m[5], -1, 1);
+    if (std::abs(sp) > 1 - 1e-6) {
+        // gimbal lock; only yaw + roll (or yaw - roll) is known
+        return Orient3D(atan2(-m.m[6], m.m[0]), asin(sp), 0);
+    }
+    return Orient3D(atan2(m.m[2], m.m[8]), asin(sp), atan2(m.m[3], m.m[4]));
+}
+
+Matrix3D3 Quaternion::toMatrix() const {
+    coord_t xx = x * x, yy = y * y, zz = z * z;
+    coord_t xy = x * y, xz = x * z, yz = y * z;
+    coord_t wx = w * x, wy = w * y, wz = w * z;
+    return Matrix3D3(1 - 2 * (yy + zz), 2 * (xy - wz), 2 * (xz + wy),
+                     2 * (xy + wz), 1 - 2 * (xx + zz), 2 * (yz - wx),
+                     2 * (xz - wy), 2 * (yz + wx), 1 - 2 * (xx + yy));
+}
+
+Point3D Quaternion::rotate(const Point3D& v) const {
+    // v + 2w (u x v) + 2u x (u x v), where u = (x, y, z)
+    coord_t tx = 2 * (y * v.z - z * v.y);
+    coord_t ty = 2 * (z * v.x - x * v.z);
+    coord_t tz = 2 * (x * v.y - y * v.x);
+    return Point3D(v.x + w * tx + y * tz - z * ty,
+                   v.y + w * ty + z * tx - x * tz,
+                   v.z + w * tz + x * ty - y * tx);
+}
+
+bool Rotation3D::set(const Orient3D& r) {
+    // exact comparison; no need to wrap the angles here
+    if (hasEuler_ && r.yaw == euler_.yaw && r.pitch == euler_.pitch &&
+        r.roll == euler_.roll)
+        return false;
+    q_ = Quaternion::fromOrient3D(r);
+    euler_ = r;
+    hasEuler_ = true;
+    matrixValid_ = false;
+    return true;
+}
+
+void Rotation3D::set(const Quaternion& q) {
+    q_ = q;
+    hasEuler_ = false;
+    matrixValid_ = false;
+}
+
+const Matrix3D3& Rotation3D::matrix() const {
+    if (!matrixValid_) {
+        matrix_ = q_.toMatrix();
+        matrixValid_ = true;
+    }
+    return matrix_;
+}
+
+// translate * rotate * scale, with the scale applied to the columns
+static Matrix3DAffine composeModelMatrix(const Point3D& p, const Matrix3D3& r,
+                                         const Point3D& s) {
+    return Matrix3DAffine(r.m[0] * s.x, r.m[1] * s.y, r.m[2] * s.z, p.x,
+                          r.m[3] * s.x, r.m[4] * s.y, r.m[5] * s.z, p.y,
+                          r.m[6] * s.x, r.m[7] * s.y, r.m[8] * s.z, p.z);
+}
+
+Matrix3DAffine Renderer3D::getModelMatrix(Point3D p, Orient3D r, Point3D s) {
+    return composeModelMatrix(p, Quaternion::fromOrient3D(r).toMatrix(), s);
+}
+
+const Matrix3DAffine& ModelMatrixCache::get(const Point3D& p,
+                                            const Orient3D& r,
+                                            const Point3D& s) {
+    bool turned = rot_.set(r);
+    if (!valid_ || turned || p != pos_ || s != scale_) {
+        mat_ = composeModelMatrix(p, rot_.matrix(), s);
+        pos_ = p;
+        scale_ = s;
+        valid_ = true;
+    }
+    return mat_;
 }
 
 coord_t Orient3D::offBy(const Orient3D& other) const noexcept {
@@ -117,10 +227,14 @@ Point3D Orient3D::rotate(const Point3D& vector, coord_t scale) const noexcept {
 }
 
 Point3D Orient3D::direction(coord_t scale /* = 1 */) const noexcept {
-    return rotate(Point3D(0, 0, scale));
+    // the last column of Matrix3D3::rotate; roll does not change it
+    perfStats.add(Stat::TrigCalls, 4);
+    coord_t cp = cos(pitch);
+    return Point3D(sin(yaw) * cp, sin(pitch), cos(yaw) * cp) * scale;
 }
 
 Orient3D Orient3D::toPolar(const Point3D& p, coord_t roll) noexcept {
+    perfStats.add(Stat::TrigCalls, 2);
     coord_t yaw = atan2(p.x, p.z);
     coord_t pitch = atan2(p.y, hypot(p.x, p.z));
     return Orient3D(yaw, pitch, roll);
@@ -132,13 +246,18 @@ Orient3D Orient3D::tendTo(const Orient3D& target, coord_t rate) const noexcept {
                     angleApproach(roll, target.roll, rate));
 }
 
-Renderer3D::Renderer3D() {
+Renderer3D::Renderer3D() : instances_(instanceBlock * 16) {
     setCamera(Point3D(0, 0, 0), Orient3D(0, 0, 0), Point3D(1, 1, 1));
 }
 
+void Renderer3D::reserveLines(size_t n) {
+    lanes_.reserve(n * 2);
+    points_.reserve(n * 2);
+}
+
 static coord_t computeFOV(coord_t a) { return 1.0 / tan(a / 2.0); }
 
-static const coord_t near = 1.0 / 256;
+static const coord_t near = viewNear;
 static const coord_t far = 8;
 static const coord_t wherever_you_are = far / (far - near);
 static const coord_t s_fov = computeFOV(radians<coord_t>(90));
@@ -153,67 +272,259 @@ void Renderer3D::setCamera(Point3D pos, Orient3D rot, Point3D scale) {
     if (rot.pitch != 0) view *= Matrix3D3::pitch(-rot.pitch);
     if (rot.yaw != 0) view *= Matrix3D3::yaw(-rot.yaw);
     view *= Matrix3D::translate(-pos);
+
+    // world-space frustum planes (a, b, c, d), inside when ax+by+cz+d >= 0
+    const coord_t* m = view.m;
+    auto sideOf = [m](int i, coord_t f) {
+        return Vector3D(m[12] + f * m[i * 4 + 0], m[13] + f * m[i * 4 + 1],
+                        m[14] + f * m[i * 4 + 2], m[15] + f * m[i * 4 + 3]);
+    };
+    frustum_.clear();
+    frustum_.push_back(sideOf(0, -1));  // x <= w
+    frustum_.push_back(sideOf(0, 1));   // x >= -w
+    frustum_.push_back(sideOf(1, -1));  // y <= w
+    frustum_.push_back(sideOf(1, 1));   // y >= -w
+    frustum_.emplace_back(m[12], m[13], m[14], m[15] - near);  // w >= near
+    frustum_.emplace_back(-m[8], -m[9], -m[10],
+                          viewDistance - m[11]);  // z <= viewDistance
+    for (Vector3D& v : frustum_) {
+        coord_t l = sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+        if (l > 0) {
+            v.x /= l;
+            v.y /= l;
+            v.z /= l;
+            v.w /= l;
+        }
+    }
+}
+
+bool Renderer3D::isOutsideFrustum(const Point3D& c, coord_t r) const {
+    for (const Vector3D& v : frustum_)
+        if (v.x * c.x + v.y * c.y + v.z * c.z + v.w < -r) return true;
+    return false;
+}
+
+// false if m, drawn with the model matrix mdl (with the largest scale
+// factor scale), is culled. otherwise sets lanes to the vertices of m
+bool Renderer3D::prepareModel(const Matrix3DAffine& mdl, coord_t scale,
+                              const Model& m, const VertexLanes*& lanes) {
+    if (m.lanes.size() != m.vertices.size()) {
+        // lanes (and bounds) are out of date; no culling
+        lanes_.assign(m.vertices);
+        lanes = &lanes_;
+        return true;
+    }
+    Point3D c = mdl.project(m.bounds.center);
+    if (isOutsideFrustum(c, m.bounds.radius * scale)) return false;
+    lanes = &m.lanes;
+    return true;
+}
+
+static coord_t maxScale(const Point3D& s) {
+    return std::max({std::abs(s.x), std::abs(s.y), std::abs(s.z)});
 }
 
 void Renderer3D::renderModel(SplinterBuffer& buf, Point3D p, Orient3D r,
                              Point3D s, const Model& m) {
-    Matrix3D wrld = view * getModelMatrix(p, r, s);
-    points_.clear();
-    for (const Point3D& p : m.vertices)
-        points_.emplace_back<Vector3D>(wrld.project(Vector3D(p)));
+    renderModel(buf, getModelMatrix(p, r, s), s, m);
+}
+
+void Renderer3D::renderModel(SplinterBuffer& buf, const Matrix3DAffine& mdl,
+                             Point3D s, const Model& m) {
+    const VertexLanes* lanes;
+    if (!prepareModel(mdl, maxScale(s), m, lanes)) return;
+    projectVertexLanes(view * mdl, *lanes, points_);
     for (const ModelFragment& part : m.shapes) renderModelFragment(buf, part);
 }
 
-inline static int outcode(const Vector3D& v) {
-    return static_cast<int>((v.x > v.w) << 0) |
-           static_cast<int>((v.x < -v.w) << 1) |
-           static_cast<int>((v.y > v.w) << 2) |
-           static_cast<int>((v.y < -v.w) << 3) |
-           static_cast<int>((v.z > viewDistance) << 4) |
-           static_cast<int>((v.w < near) << 5);
+void Renderer3D::renderModels(SplinterBuffer& buf, const Matrix3DAffine& mdl,
+                              Point3D s, const ModelPart* parts, size_t n) {
+    coord_t scale = maxScale(s);
+    Matrix3D wrld = view * mdl;
+    for (size_t i = 0; i < n; ++i) {
+        const ModelPart& part = parts[i];
+        if (!part.model) continue;
+        const VertexLanes* lanes;
+        if (!prepareModel(mdl, scale, *part.model, lanes)) continue;
+        projectVertexLanes(wrld, *lanes, points_);
+        for (const ModelFragment& f : part.model->shapes)
+            renderModelFragment(buf, f);
+    }
+}
+
+void Renderer3D::renderInstances(SplinterBuffer& buf, const Model& m,
+                                 const ModelTransform* t, size_t n) {
+    if (m.lanes.size() != m.vertices.size()) {
+        for (size_t i = 0; i < n; ++i)
+            renderModel(buf, t[i].pos, t[i].rot, t[i].scale, m);
+        return;
+    }
+
+    // the instances that are not culled are drawn a block at a time. blocks
+    // of instanceBlock instances keep points_ small
+    size_t nv = m.lanes.size(), count = 0;
+    auto drawBlock = [&] {
+        projectInstances(m.lanes, count);
+        for (size_t k = 0; k < count; ++k)
+            for (const ModelFragment& part : m.shapes)
+                renderModelFragment(buf, part, k * nv);
+        count = 0;
+    };
+    for (size_t i = 0; i < n; ++i) {
+        const Point3D& s = t[i].scale;
+        Matrix3DAffine mdl =
+            t[i].matrix ? *t[i].matrix : getModelMatrix(t[i].pos, t[i].rot, s);
+        Point3D c = mdl.project(m.bounds.center);
+        if (isOutsideFrustum(c, m.bounds.radius * maxScale(s))) continue;
+        Matrix3D w = view * mdl;
+        for (size_t e = 0; e < 16; ++e)
+            instances_[e * instanceBlock + count] = w.m[e];
+        if (++count == instanceBlock) drawBlock();
+    }
+    if (count) drawBlock();
+}
+
+// vertex-major: the inner loop goes over a whole block of instances (some of
+// which may be unused), so it has a fixed trip count and is vectorized
+void Renderer3D::projectInstances(const VertexLanes& v, size_t n) {
+    size_t nv = v.size();
+    points_.resize(nv * n);
+    const coord_t* m = instances_.data();
+    constexpr size_t b = instanceBlock;
+    for (size_t j = 0; j < nv; ++j) {
+        coord_t x = v.x[j], y = v.y[j], z = v.z[j];
+        coord_t px[b], py[b], pz[b], pw[b];
+        for (size_t i = 0; i < b; ++i) {
+            px[i] = x * m[0 * b + i] + y * m[1 * b + i] + z * m[2 * b + i] +
+                    m[3 * b + i];
+            py[i] = x * m[4 * b + i] + y * m[5 * b + i] + z * m[6 * b + i] +
+                    m[7 * b + i];
+            pz[i] = x * m[8 * b + i] + y * m[9 * b + i] + z * m[10 * b + i] +
+                    m[11 * b + i];
+            pw[i] = x * m[12 * b + i] + y * m[13 * b + i] +
+                    z * m[14 * b + i] + m[15 * b + i];
+        }
+        for (size_t i = 0, o = j; i < n; ++i, o += nv) {
+            points_.x[o] = px[i];
+            points_.y[o] = py[i];
+            points_.z[o] = pz[i];
+            points_.w[o] = pw[i];
+            points_.outcode[o] = clipOutcode(px[i], py[i], pz[i], pw[i]);
+        }
+    }
+}
+
+void Renderer3D::renderLines(SplinterBuffer& buf, size_t n, const Point3D* p,
+                             const Quaternion* r, const Point3D* p0,
+                             const Point3D* p1, Point3D s, Color color) {
+    lanes_.resize(n * 2);
+    coord_t* x = lanes_.x.data();
+    coord_t* y = lanes_.y.data();
+    coord_t* z = lanes_.z.data();
+    for (size_t i = 0; i < n; ++i) {
+        Matrix3D3 rm = r[i].toMatrix();
+        const coord_t* m = rm.m;
+        Point3D a = p0[i].hadamard(s), b = p1[i].hadamard(s), c = p[i];
+        x[i * 2] = a.x * m[0] + a.y * m[1] + a.z * m[2] + c.x;
+        y[i * 2] = a.x * m[3] + a.y * m[4] + a.z * m[5] + c.y;
+        z[i * 2] = a.x * m[6] + a.y * m[7] + a.z * m[8] + c.z;
+        x[i * 2 + 1] = b.x * m[0] + b.y * m[1] + b.z * m[2] + c.x;
+        y[i * 2 + 1] = b.x * m[3] + b.y * m[4] + b.z * m[5] + c.y;
+        z[i * 2 + 1] = b.x * m[6] + b.y * m[7] + b.z * m[8] + c.z;
+    }
+    projectVertexLanes(view, lanes_, points_);
+
+    bool cut;
+    Point3D q0{0, 0, 0}, q1{0, 0, 0};
+    for (size_t i = 0; i < n; ++i) {
+        if (!clipLine(i * 2, i * 2 + 1, q0, q1, cut)) continue;
+        buf.push(Splinter{SplinterType::BeginShape, q0.x, q0.y, color});
+        buf.push(Splinter{SplinterType::Point, q1.x, q1.y, color});
+        buf.endShape();
+    }
+}
+
+void Renderer3D::renderGeometry(SplinterBuffer& buf, Point3D p,
+                                const VertexLanes& vertices,
+                                const std::vector<ModelFragment>& shapes,
+                                size_t firstVertex, size_t firstShape) {
+    projectVertexLanes(view * Matrix3DAffine::translate(p), vertices, points_,
+                       firstVertex);
+    for (size_t i = firstShape, n = shapes.size(); i < n; ++i)
+        renderModelFragment(buf, shapes[i]);
 }
 
-Point3D Renderer3D::clipPoint(const Vector3D& onScreen,
-                              const Vector3D& offScreen) {
-    coord_t n = unlerp(onScreen.w, near, offScreen.w);
-    return Vector3D(lerp(onScreen.x, n, offScreen.x),
-                    lerp(onScreen.y, n, offScreen.y),
-                    lerp(onScreen.z, n, offScreen.z), near)
-        .toCartesian();
+// Liang-Barsky against the six clip planes in homogeneous coordinates.
+// each boundary function is >= 0 inside
+static inline bool clipEdge(coord_t f0, coord_t f1, coord_t& t0, coord_t& t1) {
+    if (f0 < 0) {
+        if (f1 < 0) return false;
+        t0 = std::max(t0, f0 / (f0 - f1));
+    } else if (f1 < 0) {
+        t1 = std::min(t1, f0 / (f0 - f1));
+    }
+    return t0 <= t1;
 }
 
-bool Renderer3D::clipLine(const Vector3D& v0, const Vector3D& v1, Point3D& p0,
-                          Point3D& p1) const {
-    int o0 = outcode(v0), o1 = outcode(v1);
+bool Renderer3D::clipLine(size_t i0, size_t i1, Point3D& p0, Point3D& p1,
+                          bool& cut) const {
+    int o0 = points_.outcode[i0], o1 = points_.outcode[i1];
+    if (o0 & o1) return false;
+    perfStats.add(Stat::LinesUnclipped);
 
+    Vector3D v0 = points_[i0], v1 = points_[i1];
     if (!(o0 | o1)) {
         p0 = v0.toCartesian();
         p1 = v1.toCartesian();
+        cut = false;
+        perfStats.add(Stat::LinesClipped);
         return true;
     }
-    if (o0 & o1) return false;
 
-    p0 = v0.w >= near ? v0.toCartesian() : clipPoint(v1, v0);
-    p1 = v1.w >= near ? v1.toCartesian() : clipPoint(v0, v1);
+    coord_t t0 = 0, t1 = 1;
+    if (!clipEdge(v0.w - v0.x, v1.w - v1.x, t0, t1) ||
+        !clipEdge(v0.w + v0.x, v1.w + v1.x, t0, t1) ||
+        !clipEdge(v0.w - v0.y, v1.w - v1.y, t0, t1) ||
+        !clipEdge(v0.w + v0.y, v1.w + v1.y, t0, t1) ||
+        !clipEdge(viewDistance - v0.z, viewDistance - v1.z, t0, t1) ||
+        !clipEdge(v0.w - near, v1.w - near, t0, t1))
+        return false;
+
+    Vector3D d = v1 - v0;
+    p0 = t0 > 0 ? Vector3D(v0.x + t0 * d.x, v0.y + t0 * d.y, v0.z + t0 * d.z,
+                           v0.w + t0 * d.w)
+                      .toCartesian()
+                : v0.toCartesian();
+    p1 = t1 < 1 ? Vector3D(v0.x + t1 * d.x, v0.y + t1 * d.y, v0.z + t1 * d.z,
+                           v0.w + t1 * d.w)
+                      .toCartesian()
+                : v1.toCartesian();
+    cut = t1 < 1;
+    perfStats.add(Stat::LinesClipped);
     return true;
 }
 
 void Renderer3D::renderModelFragment(SplinterBuffer& buf,
-                                     const ModelFragment& f) const {
-    bool visible, shape = false;
+                                     const ModelFragment& f,
+                                     size_t offset) const {
+    bool visible, cut, shape = false;
     Color clr = f.color;
-    const Vector3D* v0 = &points_[f.start];
-    const Vector3D* v1;
+    size_t v0 = f.start + offset;
     Point3D p0{0, 0, 0}, p1{0, 0, 0};
-    for (size_t p : f.points) {
-        v1 = &points_[p];
-        visible = clipLine(*v0, *v1, p0, p1);
+    for (size_t v : f.points) {
+        size_t v1 = v + offset;
+        visible = clipLine(v0, v1, p0, p1, cut);
         if (visible) {
             if (!shape) {
                 buf.push(Splinter{SplinterType::BeginShape, p0.x, p0.y, clr});
                 shape = true;
             }
             buf.push(Splinter{SplinterType::Point, p1.x, p1.y, clr});
+            // the next line starts outside, so it cannot continue this shape
+            if (cut) {
+                buf.endShape();
+                shape = false;
+            }
         } else if (shape) {
             buf.endShape();
             shape = false;
@@ -0,0 +1,277 @@
+/****************************************************************************/
+/*                                                                          */
+/*   HIEMALIA SOURCE CODE (C) 2021      SAMPO HIPPELAINEN (HISAHI).         */
+/*   SEE THE LICENSE FILE IN THE SOURCE ROOT DIRECTORY FOR LICENSE INFO.    */
+/*                                                                          */
+/****************************************************************************/
+// vproj.cc: batched vertex projection kernels for Renderer3D
+
+#include "logger.hh"
+#include "rend3d.hh"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VPROJ_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define VPROJ_TARGET_AVX2
+#else
+#define VPROJ_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define VPROJ_X86 0
+#endif
+
+namespace hiemalia {
+
+using VertexKernel = void (*)(const Matrix3D&, const VertexLanes&,
+                              ProjectedVertices&, size_t);
+
+static void projectScalar(const Matrix3D& mat, const VertexLanes& v,
+                          ProjectedVertices& out, size_t i) {
+    const coord_t* m = mat.m;
+    for (size_t n = v.size(); i < n; ++i) {
+        coord_t x = v.x[i], y = v.y[i], z = v.z[i];
+        coord_t px = x * m[0] + y * m[1] + z * m[2] + m[3];
+        coord_t py = x * m[4] + y * m[5] + z * m[6] + m[7];
+        coord_t pz = x * m[8] + y * m[9] + z * m[10] + m[11];
+        coord_t pw = x * m[12] + y * m[13] + z * m[14] + m[15];
+        out.x[i] = px;
+        out.y[i] = py;
+        out.z[i] = pz;
+        out.w[i] = pw;
+        out.outcode[i] = clipOutcode(px, py, pz, pw);
+    }
+}
+
+#if VPROJ_X86
+// c[j] holds one mask bit per lane for outcode bit j
+template <size_t L>
+static inline void storeOutcodes(uint8_t* dst, const int (&c)[6]) {
+    for (size_t k = 0; k < L; ++k)
+        dst[k] = static_cast<uint8_t>(
+            ((c[0] >> k) & 1) << 0 | ((c[1] >> k) & 1) << 1 |
+            ((c[2] >> k) & 1) << 2 | ((c[3] >> k) & 1) << 3 |
+            ((c[4] >> k) & 1) << 4 | ((c[5] >> k) & 1) << 5);
+}
+
+#if COORD_FLOAT
+static void projectSSE2(const Matrix3D& mat, const VertexLanes& v,
+                        ProjectedVertices& out, size_t i) {
+    const coord_t* m = mat.m;
+    __m128 mm[16];
+    for (size_t j = 0; j < 16; ++j) mm[j] = _mm_set1_ps(m[j]);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const __m128 dist = _mm_set1_ps(viewDistance);
+    const __m128 near = _mm_set1_ps(viewNear);
+
+    for (size_t n = v.size(); i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(&v.x[i]);
+        __m128 y = _mm_loadu_ps(&v.y[i]);
+        __m128 z = _mm_loadu_ps(&v.z[i]);
+#define VPROJ_ROW(a, b, c, d)                                             \
+    _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, mm[a]),               \
+                                     _mm_mul_ps(y, mm[b])),              \
+                          _mm_mul_ps(z, mm[c])),                         \
+               mm[d])
+        __m128 px = VPROJ_ROW(0, 1, 2, 3);
+        __m128 py = VPROJ_ROW(4, 5, 6, 7);
+        __m128 pz = VPROJ_ROW(8, 9, 10, 11);
+        __m128 pw = VPROJ_ROW(12, 13, 14, 15);
+#undef VPROJ_ROW
+        _mm_storeu_ps(&out.x[i], px);
+        _mm_storeu_ps(&out.y[i], py);
+        _mm_storeu_ps(&out.z[i], pz);
+        _mm_storeu_ps(&out.w[i], pw);
+
+        __m128 nw = _mm_xor_ps(pw, sign);
+        int c[6] = {_mm_movemask_ps(_mm_cmpgt_ps(px, pw)),
+                    _mm_movemask_ps(_mm_cmplt_ps(px, nw)),
+                    _mm_movemask_ps(_mm_cmpgt_ps(py, pw)),
+                    _mm_movemask_ps(_mm_cmplt_ps(py, nw)),
+                    _mm_movemask_ps(_mm_cmpgt_ps(pz, dist)),
+                    _mm_movemask_ps(_mm_cmplt_ps(pw, near))};
+        storeOutcodes<4>(&out.outcode[i], c);
+    }
+    projectScalar(mat, v, out, i);
+}
+
+VPROJ_TARGET_AVX2 static void projectAVX2(const Matrix3D& mat,
+                                          const VertexLanes& v,
+                                          ProjectedVertices& out, size_t i) {
+    const coord_t* m = mat.m;
+    __m256 mm[16];
+    for (size_t j = 0; j < 16; ++j) mm[j] = _mm256_set1_ps(m[j]);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256 dist = _mm256_set1_ps(viewDistance);
+    const __m256 near = _mm256_set1_ps(viewNear);
+
+    for (size_t n = v.size(); i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(&v.x[i]);
+        __m256 y = _mm256_loadu_ps(&v.y[i]);
+        __m256 z = _mm256_loadu_ps(&v.z[i]);
+#define VPROJ_ROW(a, b, c, d)                                             \
+    _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, mm[a]),   \
+                                              _mm256_mul_ps(y, mm[b])),  \
+                                _mm256_mul_ps(z, mm[c])),                \
+                  mm[d])
+        __m256 px = VPROJ_ROW(0, 1, 2, 3);
+        __m256 py = VPROJ_ROW(4, 5, 6, 7);
+        __m256 pz = VPROJ_ROW(8, 9, 10, 11);
+        __m256 pw = VPROJ_ROW(12, 13, 14, 15);
+#undef VPROJ_ROW
+        _mm256_storeu_ps(&out.x[i], px);
+        _mm256_storeu_ps(&out.y[i], py);
+        _mm256_storeu_ps(&out.z[i], pz);
+        _mm256_storeu_ps(&out.w[i], pw);
+
+        __m256 nw = _mm256_xor_ps(pw, sign);
+        int c[6] = {
+            _mm256_movemask_ps(_mm256_cmp_ps(px, pw, _CMP_GT_OQ)),
+            _mm256_movemask_ps(_mm256_cmp_ps(px, nw, _CMP_LT_OQ)),
+            _mm256_movemask_ps(_mm256_cmp_ps(py, pw, _CMP_GT_OQ)),
+            _mm256_movemask_ps(_mm256_cmp_ps(py, nw, _CMP_LT_OQ)),
+            _mm256_movemask_ps(_mm256_cmp_ps(pz, dist, _CMP_GT_OQ)),
+            _mm256_movemask_ps(_mm256_cmp_ps(pw, near, _CMP_LT_OQ))};
+        storeOutcodes<8>(&out.outcode[i], c);
+    }
+    // short tails go through the SSE2 kernel (which handles the last ones)
+    projectSSE2(mat, v, out, i);
+}
+#else
+static void projectSSE2(const Matrix3D& mat, const VertexLanes& v,
+                        ProjectedVertices& out, size_t i) {
+    const coord_t* m = mat.m;
+    __m128d mm[16];
+    for (size_t j = 0; j < 16; ++j) mm[j] = _mm_set1_pd(m[j]);
+    const __m128d sign = _mm_set1_pd(-0.0);
+    const __m128d dist = _mm_set1_pd(viewDistance);
+    const __m128d near = _mm_set1_pd(viewNear);
+
+    for (size_t n = v.size(); i + 2 <= n; i += 2) {
+        __m128d x = _mm_loadu_pd(&v.x[i]);
+        __m128d y = _mm_loadu_pd(&v.y[i]);
+        __m128d z = _mm_loadu_pd(&v.z[i]);
+#define VPROJ_ROW(a, b, c, d)                                             \
+    _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(x, mm[a]),               \
+                                     _mm_mul_pd(y, mm[b])),              \
+                          _mm_mul_pd(z, mm[c])),                         \
+               mm[d])
+        __m128d px = VPROJ_ROW(0, 1, 2, 3);
+        __m128d py = VPROJ_ROW(4, 5, 6, 7);
+        __m128d pz = VPROJ_ROW(8, 9, 10, 11);
+        __m128d pw = VPROJ_ROW(12, 13, 14, 15);
+#undef VPROJ_ROW
+        _mm_storeu_pd(&out.x[i], px);
+        _mm_storeu_pd(&out.y[i], py);
+        _mm_storeu_pd(&out.z[i], pz);
+        _mm_storeu_pd(&out.w[i], pw);
+
+        __m128d nw = _mm_xor_pd(pw, sign);
+        int c[6] = {_mm_movemask_pd(_mm_cmpgt_pd(px, pw)),
+                    _mm_movemask_pd(_mm_cmplt_pd(px, nw)),
+                    _mm_movemask_pd(_mm_cmpgt_pd(py, pw)),
+                    _mm_movemask_pd(_mm_cmplt_pd(py, nw)),
+                    _mm_movemask_pd(_mm_cmpgt_pd(pz, dist)),
+                    _mm_movemask_pd(_mm_cmplt_pd(pw, near))};
+        storeOutcodes<2>(&out.outcode[i], c);
+    }
+    projectScalar(mat, v, out, i);
+}
+
+VPROJ_TARGET_AVX2 static void projectAVX2(const Matrix3D& mat,
+                                          const VertexLanes& v,
+                                          ProjectedVertices& out, size_t i) {
+    const coord_t* m = mat.m;
+    __m256d mm[16];
+    for (size_t j = 0; j < 16; ++j) mm[j] = _mm256_set1_pd(m[j]);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const __m256d dist = _mm256_set1_pd(viewDistance);
+    const __m256d near = _mm256_set1_pd(viewNear);
+
+    for (size_t n = v.size(); i + 4 <= n; i += 4) {
+        __m256d x = _mm256_loadu_pd(&v.x[i]);
+        __m256d y = _mm256_loadu_pd(&v.y[i]);
+        __m256d z = _mm256_loadu_pd(&v.z[i]);
+#define VPROJ_ROW(a, b, c, d)                                             \
+    _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(x, mm[a]),   \
+                                              _mm256_mul_pd(y, mm[b])),  \
+                                _mm256_mul_pd(z, mm[c])),                \
+                  mm[d])
+        __m256d px = VPROJ_ROW(0, 1, 2, 3);
+        __m256d py = VPROJ_ROW(4, 5, 6, 7);
+        __m256d pz = VPROJ_ROW(8, 9, 10, 11);
+        __m256d pw = VPROJ_ROW(12, 13, 14, 15);
+#undef VPROJ_ROW
+        _mm256_storeu_pd(&out.x[i], px);
+        _mm256_storeu_pd(&out.y[i], py);
+        _mm256_storeu_pd(&out.z[i], pz);
+        _mm256_storeu_pd(&out.w[i], pw);
+
+        __m256d nw = _mm256_xor_pd(pw, sign);
+        int c[6] = {
+            _mm256_movemask_pd(_mm256_cmp_pd(px, pw, _CMP_GT_OQ)),
+            _mm256_movemask_pd(_mm256_cmp_pd(px, nw, _CMP_LT_OQ)),
+            _mm256_movemask_pd(_mm256_cmp_pd(py, pw, _CMP_GT_OQ)),
+            _mm256_movemask_pd(_mm256_cmp_pd(py, nw, _CMP_LT_OQ)),
+            _mm256_movemask_pd(_mm256_cmp_pd(pz, dist, _CMP_GT_OQ)),
+            _mm256_movemask_pd(_mm256_cmp_pd(pw, near, _CMP_LT_OQ))};
+        storeOutcodes<4>(&out.outcode[i], c);
+    }
+    // short tails go through the SSE2 kernel (which handles the last one)
+    projectSSE2(mat, v, out, i);
+}
+#endif  // COORD_FLOAT
+
+static bool cpuHasAVX2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    // OSXSAVE and AVX, and the OS must save the YMM state
+    if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+        return false;
+    if ((_xgetbv(0) & 6) != 6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+struct VertexKernelEntry {
+    VertexKernel kernel;
+    const char* name;
+};
+
+static VertexKernelEntry pickVertexKernel() {
+#if VPROJ_X86
+    if (cpuHasAVX2()) return {&projectAVX2, "avx2"};
+    return {&projectSSE2, "sse2"};
+#else
+    return {&projectScalar, "scalar"};
+#endif
+}
+
+static const VertexKernelEntry& vertexKernel() {
+    static const VertexKernelEntry entry = [] {
+        VertexKernelEntry e = pickVertexKernel();
+        LOG_DEBUG("using %s vertex projection kernel", e.name);
+        return e;
+    }();
+    return entry;
+}
+
+const char* vertexKernelName() { return vertexKernel().name; }
+
+void projectVertexLanes(const Matrix3D& m, const VertexLanes& v,
+                        ProjectedVertices& out, size_t first) {
+    out.resize(v.size());
+    vertexKernel().kernel(m, v, out, first);
+}
+
+}  // namespace hiemalia